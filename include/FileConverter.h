@@ -4,6 +4,31 @@
 #include <QObject>
 #include <QTemporaryFile>
 #include <QDir>
+#include <QSharedPointer>
+#include "progressreporter.h"
+#include "datacache.h"
+
+/*
+ * The LoadedFile struct carries the decoded columns of one input file from
+ * FileConverter to DCController in a single hand-off. The receiver moves the
+ * arrays into DataLoaders instead of copying them.
+ */
+struct LoadedFile
+{
+    QString fileId;
+
+    QVector<double> X;
+
+    QVector<double> Y;
+
+    QVector<double> addY;   // X axis of DV files
+
+    bool dualAxis {false};  // DV file: Y is the "_Z" axis, addY the "_X" axis, both on X
+
+    double syncFactor {0.0};
+
+    double delta {0.0};
+};
 
 /*
  * The FileConverter class loads and converts input files (PRZ/IFH/DVL/stage)
@@ -51,15 +76,33 @@ private:
 
     double syncFactor {0.0};
 
+    std::function<bool()> cancelCheck; // set by LoadScheduler; loading stops when it returns true
+
+    DataCache::Source cacheSource; // the source as readCache found it
+
     void loadStageFile(const QString &file_path, QVector<double> &X, QVector<double> &Y);
 
-    void loadPRZ(const QString &file_path, QVector<double> &X, QVector<double> &Y);
+    void loadPRZ(const QString &file_path, QVector<double> &X, QVector<double> &Y,
+                 const ProgressReporter &progress);
+
+    void loadIFH1(const QString &file_path, QVector<double> &X, QVector<double> &Y,
+                  const ProgressReporter &progress);
+
+    void loadIFHdvl(const QString &file_path, QVector<double> &X, QVector<double> &Y, QVector<double> &addY,
+                    const ProgressReporter &progress);
 
-    void loadIFH1(const QString &file_path, QVector<double> &X, QVector<double> &Y);
+    void decodeIFH(const uchar *data, qint64 size, int step, const ProgressReporter &progress,
+                   QVector<double> &X, QVector<double> &Y, QVector<double> *addY);
 
-    void loadIFHdvl(const QString &file_path, QVector<double> &X, QVector<double> &Y, QVector<double> &addY);
+    void readIFHTrailer(const uchar *data, qint64 size);
 
-    void medianFilter(QVector<double> &data, int radius);
+    void medianFilter(QVector<double> &data, int radius, const ProgressReporter &progress);
+
+    // sidecar cache of decoded columns (see DataCache); filterWindow is the median applied
+    bool readCache(QVector<double> &X, QVector<double> &Y, QVector<double> *addY, int filterWindow);
+
+    // stores under the source described by the readCache call before it
+    void writeCache(const QVector<double> &X, const QVector<double> &Y, const QVector<double> *addY);
 
 public:
 
@@ -71,6 +114,10 @@ public:
 
     void setWindow(int width);
 
+    void setCancelCheck(std::function<bool()> check);
+
+    bool isCancelled() const;
+
     void set_file_path(const QString &file_path); // method for setting file path
 
     QString datConvert(); // method for converting a file. Returns the new file path
@@ -110,12 +157,13 @@ signals:
 
     void progressUpdated(const QString &fileId, int percent);
 
-    void finished(QString fileId, QVector<double> X, QVector<double> Y,
-                  double syncFactor, double delta);
+    void finished(QSharedPointer<LoadedFile> file);
 
     void errorOccurred(QString fileId, QString message);
 
 
 };
 
+Q_DECLARE_METATYPE(QSharedPointer<LoadedFile>)
+
 #endif // FILECONVERTER_H
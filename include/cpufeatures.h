@@ -0,0 +1,57 @@
+#ifndef CPUFEATURES_H
+#define CPUFEATURES_H
+
+#include <QtGlobal>
+
+/*
+ * The CpuFeatures functions tell the kernel files (IfhKernels, PrzKernels)
+ * which SIMD instruction sets they may use, so each picks its implementation
+ * once at runtime.
+ *
+ * Responsibilities:
+ * - Detect SSSE3, AVX and AVX2, including OS support for the YMM registers
+ * - Define CPU_FEATURES_X86 and CPU_TARGET(isa), which builds a single
+ *   function for an instruction set above the compiler baseline
+ * - Carry the selected kernel with its name and log the choice once
+ */
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CPU_FEATURES_X86
+#include <immintrin.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define CPU_TARGET(isa)
+#else
+#define CPU_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace CpuFeatures
+{
+    // false on other architectures
+    bool hasSsse3();
+
+    bool hasAvx();
+
+    bool hasAvx2();
+
+    // an implementation of a kernel and its name for the log
+    template <typename Kernel>
+    struct Backend
+    {
+        Kernel kernel;
+        const char *name;
+    };
+
+    void logSelected(const char *what, const char *name);
+
+    // logs the choice and passes it on; meant for the static that holds it
+    template <typename Kernel>
+    Backend<Kernel> selected(const char *what, const Backend<Kernel> &backend)
+    {
+        logSelected(what, backend.name);
+        return backend;
+    }
+}
+
+#endif // CPUFEATURES_H
@@ -0,0 +1,58 @@
+#ifndef DATACACHE_H
+#define DATACACHE_H
+
+#include <QString>
+#include <QVector>
+
+/*
+ * The DataCache functions keep the decoded columns of an input file in a
+ * binary sidecar ("<file>.dccache") so that reopening the same file skips
+ * parsing and filtering.
+ *
+ * Responsibilities:
+ * - Store X/Y (and the second DV axis) together with the trailer sync points
+ * - Validate a cache against the source size, mtime, a hash of the whole
+ *   source and the filter window it was built with
+ * - Read the columns of a valid cache straight into their arrays (one copy,
+ *   no intermediate buffer)
+ * - Describe the source once per load, so a miss followed by a store reads
+ *   the source a single time
+ */
+namespace DataCache
+{
+    struct Entry
+    {
+        QVector<double> X;
+        QVector<double> Y;
+        QVector<double> addY;   // empty unless the file has a second axis
+
+        double startPoint {0.0};
+        double finishPoint {0.0};
+        double refStartPoint {0.0};
+        double refFinishPoint {0.0};
+    };
+
+    // what a cache is validated against
+    struct Source
+    {
+        qint64 size {-1};       // -1: the source could not be read
+        qint64 mtime {0};       // ms since epoch
+        quint64 fingerprint {0};
+        int filterWindow {0};
+
+        bool isValid() const {return size >= 0;}
+    };
+
+    QString cachePath(const QString &sourcePath);
+
+    // reads the whole source to hash it; taken before decoding and passed to load and store
+    Source describe(const QString &sourcePath, int filterWindow);
+
+    // false if there is no cache or it does not match the source/filter window
+    bool load(const QString &sourcePath, const Source &source, Entry &entry);
+
+    // writes the cache atomically; failures (e.g. a read-only folder) only log
+    bool store(const QString &sourcePath, const Source &source, const Entry &entry);
+}
+
+#endif // DATACACHE_H
@@ -1,5 +1,36 @@
 #ifndef DATALOADER_H
 #define DATALOADER_H
+#include "timebase.h"
+#include "minmaxpyramid.h"
+#include "resampleplan.h"
+#include <memory>
+
+/*
+ * The PlotSource struct is a read-only copy of what DataLoader::update()
+ * works on. The arrays are implicitly shared with the loader, so taking it is
+ * cheap, and later edits of the loader detach instead of racing with a
+ * reader on another thread.
+ */
+struct PlotSource
+{
+    PlotSource(const QVector<double> &X, const QVector<double> &Y, const TimeBase &timeBase,
+               const MinMaxPyramid &pyramid, int maxSize);
+
+    PlotSource(const PlotSource &) = delete; // timeBase refers to this->X
+
+    PlotSource &operator=(const PlotSource &) = delete;
+
+    void update(double min, double max, QVector<double> &vis_x, QVector<double> &vis_y) const;
+
+    const QVector<double> X, Y;
+
+    TimeBase timeBase;
+
+    const MinMaxPyramid pyramid;
+
+    const int maxSize;
+};
+
 /*
  * The DataLoader class stores time series data loaded from a file and provides
  * windowed subsets for plotting and synchronization.
@@ -20,8 +51,16 @@ public:
 
     DataLoader(QVector<double> &masX, QVector<double> &masY, const QString &name);
 
+    DataLoader(QVector<double> &&masX, QVector<double> &&masY, const QString &name); // takes over the arrays
+
+    DataLoader(const TimeBase &uniformX, QVector<double> &&masY, const QString &name);
+
     void update(double min, double max, QVector<double> &vis_x, QVector<double> &vis_y) const; // method for updating the visible range on the plot
 
+    std::shared_ptr<const PlotSource> plotSource() const; // snapshot for update() on a worker thread
+
+    quint64 revision() const {return rev;} // changes with every edit of X or Y
+
     double min() const; // getters
 
     double max() const;
@@ -50,6 +89,12 @@ public:
 
     void timeSync(const double &factor); // auto synchronization
 
+    // timeSync() of curves on the same timebase (the X and Z axes of a DV sensor, see sharesTime()):
+    // one walk over the timestamps of axes[0] resamples all of them in place, block by block
+    static void timeSync(const QVector<DataLoader *> &axes, const double &factor);
+
+    bool sharesTime(const DataLoader &other) const; // same timestamps, point by point
+
     QString getName() const; // file name getter
 
     bool getSyncState();
@@ -63,7 +108,7 @@ public:
 
     QString FilePath() const;
 
-    const QVector<double>& getX() const;
+    const TimeBase& getX() const; // explicit or implicit uniform timestamps
 
     const QVector<double>& getY() const;
 
@@ -77,7 +122,9 @@ public:
 
     double getShiftAmount();
 
-    void setYData( QVector<double> &yData);
+    // keepsOrder: yData is an increasing function of the current Y (shift, positive scale),
+    // so the extreme index stays valid and is not rebuilt
+    void setYData( QVector<double> &yData, bool keepsOrder = false);
 
     double yRange();
 
@@ -97,7 +144,23 @@ public:
 
 private:
 
-    QVector<double> X, Y; // arrays storing all points in memory
+    QVector<double> X, Y; // arrays storing all points in memory (X is empty on a uniform timebase)
+
+    TimeBase timeBase; // view of X, or the grid start + k * step after resample/timeSync, plus the pending shift
+
+    void makeExplicit(); // stores the actual timestamps (grid, pending shift) in X before editing them
+
+    void setUniformX(double start, double step, qsizetype count);
+
+    MinMaxPyramid pyramid; // extremes of Y for plot decimation and min/max queries
+
+    double extreme(const double &start, const double &finish, bool isMin) const;
+
+    void updateIndexes(); // rebuilds the structures derived from Y after it changes
+
+    quint64 rev {0};
+
+    void touch(); // takes a new revision
 
     QString path; // path to the source file
 
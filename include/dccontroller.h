@@ -6,6 +6,8 @@
 #include "plotwidget.h"
 #include "mainwindow.h"
 #include "snapshotmanager.h"
+#include "loadscheduler.h"
+#include "FileConverter.h"
 
 /*
  * The DCController class coordinates file loading, conversions, plotting,
@@ -44,9 +46,9 @@ private:
 
     QVector<DataLoader*> loaders;
 
-    int filesToLoad {0};
+    LoadScheduler loadScheduler;
 
-    int filesLoaded {0};
+    quint64 loadGeneration {0}; // results of an earlier (cancelled) load are ignored
 
     QVector<double> syncFactors;
 
@@ -56,15 +58,14 @@ private:
 
     MainWindow* window = nullptr;
 
-    void startConverter(const QString& path);
-
     void onProgress(const QString &fileId, int percent);
 
-    void onFinished(QString fileId, QVector<double> X,
-                                  QVector<double> Y, double syncFactor, double delta);
+    void onFinished(QSharedPointer<LoadedFile> file);
 
     void onError(QString fileId, QString msg);
 
+    void onFilesLoaded(bool cancelled);
+
     QVector<double> measureData;
 
     // method for resampling with step newStep
@@ -126,13 +127,13 @@ private slots:
 
     void savePDOLFile(const QString &path, const QString &format);
 
-    void initTables(QVector<QCPItemRect*> *rectangles); // slot for initial filling of interval tables
+    void initTables(const IntervalModel &intervals); // slot for initial filling of interval tables
 
     void deleteInterval(const QString &first, const QString &second);
 
     void addInterval(const QString &first, const QString &second);
 
-    void intervalsChanged(const QVector<QCPItemRect*> &intervals);
+    void intervalsChanged(const IntervalModel &intervals);
 
     void shiftGraph(const double &num);
 
@@ -11,6 +11,9 @@ struct SettingsDelta
     std::optional<double> dvExp;
     std::optional<double> sampStep;
     std::optional<double> minCandleLen;
+    std::optional<bool> useCache;
+    std::optional<int> loadWorkers;
+    std::optional<bool> useOpenGl;
 };
 
 
@@ -37,6 +40,12 @@ public:
 
     bool getTimeSync() const {return timeSync;}
 
+    bool getUseCache() const {return useCache;}
+
+    int getLoadWorkers() const {return loadWorkers;}
+
+    bool getUseOpenGl() const {return useOpenGl;}
+
     int getDnMed() const {return dnMed;}
 
     int getDvMed() const {return dvMed;}
@@ -99,6 +108,8 @@ signals:
 
     void graphColorsReseted();
 
+    void renderBackendChanged(); // useOpenGl was changed
+
 private:
 
     QSettings settings;
@@ -107,6 +118,12 @@ private:
 
     bool timeSync;
 
+    bool useCache;
+
+    int loadWorkers;
+
+    bool useOpenGl;
+
     int dnMed;
 
     int dvMed;
@@ -140,6 +157,12 @@ private:
 
     bool timeSyncDef() const {return true;}
 
+    bool useCacheDef() const {return true;}
+
+    int loadWorkersDef() const {return 0;} // 0 - one worker per hardware thread
+
+    bool useOpenGlDef() const {return false;} // raster until measured on the machine
+
     int dnMedDef() const {return 3;}
 
     int dvMedDef() const {return 3;}
@@ -3,6 +3,8 @@
 
 #include <QObject>
 #include "dataloader.h"
+#include "intervalmodel.h"
+#include "intervalstats.h"
 
 /*
  * The Gl1Manager class computes PD/GL1 outputs from PRZ data, derives candle
@@ -31,17 +33,17 @@ public:
 
     void setWindowWidth(const int &num);
 
-    void przToPD(const QVector<double> *X,
+    void przToPD(const TimeBase *X,
                  const QVector<double> *Y,
-                 QVector<QCPItemRect*> &intervals,
+                 IntervalModel &intervals,
                  double time,
                  double depth,
                  const double &firstPoint,
                  const double &secondPoint); // create drill bit position file
 
-    void przToGl1(const QVector<double> *X,
+    void przToGl1(const TimeBase *X,
                  const QVector<double> *Y,
-                 QVector<QCPItemRect*> &intervals,
+                 IntervalModel &intervals,
                  double time,
                  double depth,
                  const double &firstPoint,
@@ -57,23 +59,25 @@ public:
 
     // determine candle lengths
     void getLenghts(QVector<double> &lenghts,
-                    const QVector<double> *X,
-                    const QVector<double> *Y,
-                    const QVector<QCPItemRect*> &intervals);
+                    const DataLoader *curve,
+                    const IntervalModel &intervals);
 
     // determine all parameters
     void getParams(QVector<double> &lenghts,
                QVector<double> &depth,
                QVector<double> &speed,
-               const QVector<double> *X,
-               const QVector<double> *Y,
-               const QVector<QCPItemRect*> &intervals);
+               const DataLoader *curve,
+               const IntervalModel &intervals);
+
+    // parameters of all intervals on several curves at once; unchanged intervals are not recomputed
+    QVector<QVector<IntervalStats::Row>> getParams(const QVector<const DataLoader*> &curves,
+                                                   const IntervalModel &intervals);
 
     // candle-based correction
     void candleCorrection(DataLoader *loader,
                           QVector<double> &lenghts,
                           QVector<double> &measLengths,
-                          const QVector<QCPItemRect*> &intervals,
+                          const IntervalModel &intervals,
                           const double &window);
 
     // total-length correction
@@ -98,16 +102,18 @@ private:
 
     QVector<double> measure;
 
-    QVector<QCPItemRect*> moveIntervals;
+    IntervalModel moveIntervals;
+
+    IntervalStats intervalStats;
 
     int windowWidth;
 
     bool localPrzToPD(QVector<double> &resX,
                       QVector<double> &resY,
                       QVector<double> &lenghts,
-                      const QVector<double> *X,
+                      const TimeBase *X,
                       const QVector<double> *Y,
-                      QVector<QCPItemRect*> &intervals,
+                      IntervalModel &intervals,
                       double time,
                       double depth,
                       const double &firstPoint,
@@ -0,0 +1,23 @@
+#ifndef IFHKERNELS_H
+#define IFHKERNELS_H
+
+#include <QtGlobal>
+
+/*
+ * The IfhKernels functions decode the signed 24-bit big-endian axis values
+ * packed into 16-byte IFH frames.
+ *
+ * Responsibilities:
+ * - Gather, byte-swap and sign-extend the Z (bytes 13..15) and X (bytes 7..9)
+ *   axes of a block of frames and convert them to double
+ * - Choose an AVX2, SSSE3 or scalar implementation once at runtime and log it
+ */
+namespace IfhKernels
+{
+    constexpr int frameSize = 16;
+
+    // decodes `count` consecutive frames; `x` may be nullptr when the X axis is not needed
+    void extractAxes(const uchar *frames, qsizetype count, double *z, double *x);
+}
+
+#endif // IFHKERNELS_H
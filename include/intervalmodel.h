@@ -0,0 +1,116 @@
+#ifndef INTERVALMODEL_H
+#define INTERVALMODEL_H
+
+#include <QVector>
+#include <memory>
+#include "timebase.h"
+
+/*
+ * The IntervalModel class is the sorted list of movement intervals (candles),
+ * kept apart from the plot items that draw them.
+ *
+ * Responsibilities:
+ * - Store disjoint intervals ordered by start, each with a stable id that
+ *   survives trims (the right part of a split gets a new one)
+ * - Find the interval at a time and the intervals touching a range in O(log m)
+ * - Add an interval merging the ones it overlaps, remove a range trimming or
+ *   splitting the ones it cuts, crop to a range
+ * - Map the intervals to sample indices of a curve in one merged sweep and
+ *   cache them per curve state; an edit drops only the indices of the
+ *   intervals it changed
+ *
+ * Copies share the index cache until one of them is edited.
+ */
+class IntervalModel
+{
+public:
+
+    struct Interval
+    {
+        double start;
+        double finish;
+        quint64 id;
+    };
+
+    // samples [first, end) of a curve that lie inside an interval
+    struct SampleRange
+    {
+        qsizetype first;
+        qsizetype end;
+
+        bool isEmpty() const {return first >= end;}
+    };
+
+    using const_iterator = QVector<Interval>::const_iterator;
+
+    qsizetype size() const {return items.size();}
+
+    bool isEmpty() const {return items.isEmpty();}
+
+    const Interval &operator[](qsizetype i) const {return items[i];}
+
+    const Interval &front() const {return items.front();}
+
+    const Interval &back() const {return items.back();}
+
+    const_iterator begin() const {return items.begin();}
+
+    const_iterator end() const {return items.end();}
+
+    void clear();
+
+    // adds an interval after the last one (building the list in time order)
+    void append(double start, double finish);
+
+    // index of the interval containing x, -1 if x lies in a gap
+    qsizetype indexAt(double x) const;
+
+    // first interval ending at or after x (size() if none)
+    qsizetype firstEndingFrom(double x) const;
+
+    // adds [start, finish] merged with the intervals it touches; false if it was already covered.
+    // Unlike PlotWidget::addInterval before it, an interval swallowing every later one is kept
+    bool unite(double start, double finish);
+
+    // removes [start, finish]: covered intervals are dropped, cut ones trimmed or split.
+    // Unlike PlotWidget::deleteInterval before it, a cut ending exactly at the end of an
+    // interval trims it (this is also what crop() does to the last one)
+    bool subtract(double start, double finish);
+
+    // drops everything outside [start, finish]
+    bool crop(double start, double finish);
+
+    // intervals [pos, pos + n)
+    IntervalModel mid(qsizetype pos, qsizetype n) const;
+
+    // sample ranges of all intervals on X; stamp identifies the state of X
+    // (DataLoader::revision()) for the cache, 0 computes them without caching
+    QVector<SampleRange> sampleRanges(const TimeBase &X, quint64 stamp = 0) const;
+
+private:
+
+    // a cut starting this close after an interval start trims it instead of splitting off a sliver
+    static constexpr double cutTolerance = 0.008;
+
+    static constexpr int maxCurves = 4; // cached index sets (prz, PDOL, gl1, ...)
+
+    struct CurveIndex
+    {
+        quint64 stamp;
+        QVector<SampleRange> ranges; // aligned with items; first < 0 - not known yet
+    };
+
+    QVector<Interval> items;
+
+    quint64 nextId {1};
+
+    mutable std::shared_ptr<QVector<CurveIndex>> index {std::make_shared<QVector<CurveIndex>>()};
+
+    // replaces items [pos, pos + n) and forgets their sample indices
+    void replace(qsizetype pos, qsizetype n, const QVector<Interval> &with);
+
+    // first index from `from` on with X >= x (X > x if upper), by doubling steps
+    static qsizetype gallop(const TimeBase &X, qsizetype from, double x, bool upper);
+};
+
+#endif // INTERVALMODEL_H
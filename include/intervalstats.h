@@ -0,0 +1,61 @@
+#ifndef INTERVALSTATS_H
+#define INTERVALSTATS_H
+
+#include <QHash>
+#include <QVector>
+#include "dataloader.h"
+#include "intervalmodel.h"
+
+/*
+ * The IntervalStats class computes the parameters of the movement intervals
+ * (candle length, end depth, speed) on depth curves (PDOL, gl1).
+ *
+ * Responsibilities:
+ * - Take the sample indices of all intervals from one sweep over the curve
+ *   (IntervalModel::sampleRanges) and derive every row from its two ends
+ * - Keep the rows per curve state (DataLoader::revision()) and interval id,
+ *   so after an edit only the intervals it added or changed are recomputed
+ * - Serve any number of curves in one call
+ */
+class IntervalStats
+{
+public:
+
+    struct Row
+    {
+        double length;  // cm
+        double depth;   // depth at the end of the interval
+        double speed;   // per hour
+    };
+
+    // one row per interval; intervals without samples give zeros
+    QVector<Row> rows(const DataLoader *curve, const IntervalModel &intervals);
+
+    QVector<QVector<Row>> rows(const QVector<const DataLoader*> &loaders, const IntervalModel &intervals);
+
+    void clear() {curves.clear();}
+
+private:
+
+    static constexpr int maxCurves = 4;
+
+    struct Entry
+    {
+        double start;
+        double finish;
+        Row row;
+    };
+
+    struct CurveRows
+    {
+        quint64 stamp;
+        QHash<quint64, Entry> byId; // interval id -> row of the interval as it was computed
+    };
+
+    QVector<CurveRows> curves;
+
+    static Row compute(const QVector<double> &Y, const IntervalModel::Interval &interval,
+                       const IntervalModel::SampleRange &range);
+};
+
+#endif // INTERVALSTATS_H
@@ -0,0 +1,67 @@
+#ifndef LOADSCHEDULER_H
+#define LOADSCHEDULER_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+class FileConverter;
+
+/*
+ * The LoadScheduler class runs the FileConverter jobs of one load on a
+ * bounded thread pool and reports when the whole batch is done.
+ *
+ * Responsibilities:
+ * - Limit the number of concurrent converters (setting loadWorkers,
+ *   0 = hardware concurrency)
+ * - Start the largest files first so the longest job does not start last
+ * - Cancel a running batch: queued jobs are skipped, running converters
+ *   stop at their next progress check
+ * - Emit a single batchFinished() after every job has finished or failed
+ */
+class LoadScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    struct Job
+    {
+        QString path;
+        int window {0};     // median window passed to the converter
+    };
+
+    // called on the worker thread for every new converter, before it starts loading
+    using ConverterSetup = std::function<void(FileConverter *converter)>;
+
+    explicit LoadScheduler(QObject *parent = nullptr);
+
+    ~LoadScheduler();
+
+    // starts a new batch; a batch that is still running is cancelled first
+    void start(const QVector<Job> &jobs, const ConverterSetup &setup);
+
+    void cancel();
+
+    bool isRunning() const {return pending > 0;}
+
+signals:
+
+    void batchFinished(bool cancelled);
+
+private:
+
+    QThreadPool pool;
+
+    std::shared_ptr<std::atomic<bool>> cancelFlag; // shared with the jobs of the current batch
+
+    quint64 batch {0};
+
+    int pending {0};
+
+    void jobDone(quint64 jobBatch);
+};
+
+#endif // LOADSCHEDULER_H
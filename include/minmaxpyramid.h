@@ -0,0 +1,69 @@
+#ifndef MINMAXPYRAMID_H
+#define MINMAXPYRAMID_H
+
+#include <QVector>
+
+/*
+ * The MinMaxPyramid class is a multi-resolution index of the extremes of a
+ * curve, used to decimate it for drawing without losing peaks and to answer
+ * range minimum/maximum queries.
+ *
+ * Responsibilities:
+ * - Store for every level the positions of the minimum and maximum of each
+ *   block of 4, 8, 16, ... samples (built once in O(n))
+ * - Decimate any index range into M4 buckets (first, min, max, last) by
+ *   picking the level that matches the requested bucket count, so the cost
+ *   depends on the number of buckets and not on the number of samples
+ * - Find the minimum/maximum of any index range in O(log n) by covering it
+ *   with aligned blocks, and of the whole curve in O(1)
+ * - Stay valid when the values change but keep their order (the index
+ *   stores positions only)
+ * - Follow a curve that was shortened at its end without a full rebuild
+ *
+ * Every sample of the range belongs to exactly one bucket, so the drawn
+ * envelope always contains the true minimum and maximum.
+ */
+class MinMaxPyramid
+{
+public:
+
+    void build(const QVector<double> &data);
+
+    void clear();
+
+    // data was shortened at its end (chop); only the last block of each level changes
+    void truncate(const QVector<double> &data);
+
+    // index of the minimum/maximum of data[from..to]; -1 for an empty range
+    int minIndex(const QVector<double> &data, int from, int to) const;
+
+    int maxIndex(const QVector<double> &data, int from, int to) const;
+
+    // appends ascending indices of about `buckets` M4 buckets covering [from, to];
+    // the range is widened to whole blocks of the chosen level
+    void decimate(const QVector<double> &data, int from, int to, int buckets,
+                  QVector<int> &out) const;
+
+private:
+
+    static constexpr int baseShift = 2; // the finest level has blocks of 4 samples
+
+    struct Level
+    {
+        QVector<int> minIdx;
+        QVector<int> maxIdx;
+    };
+
+    QVector<Level> levels;
+
+    // extremes of block j of a level; level -1 is the raw samples
+    int minOf(int level, int j) const {return level < 0 ? j : levels[level].minIdx[j];}
+
+    int maxOf(int level, int j) const {return level < 0 ? j : levels[level].maxIdx[j];}
+
+    int extremeIndex(const QVector<double> &data, int from, int to, bool isMin) const;
+
+    void fillBlock(const QVector<double> &data, int level, int j);
+};
+
+#endif // MINMAXPYRAMID_H
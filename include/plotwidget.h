@@ -24,6 +24,9 @@
 #include <QWidget>
 #include "qcustomplot.h"
 #include "dataloader.h"
+#include "windowpreparer.h"
+#include "replotscheduler.h"
+#include "intervalmodel.h"
 #include <QObject>
 #include <QColor>
 
@@ -68,7 +71,7 @@ public:
 
     void addLoader(const DataLoader *loader);
 
-    void getPDIntervals(QVector<QCPItemRect*> &intr);
+    void getPDIntervals(IntervalModel &intr);
 
     void getPDIntervals(QVector<QCPItemRect*> &intr, QVector<QCPItemText*> &lbls);
 
@@ -99,6 +102,8 @@ public:
 
     void updateGraphColors();
 
+    static bool openGlAvailable(); // an FBO-capable OpenGL context can be created (probed once)
+
 private:
 
     QVector<const DataLoader*> files; // pointer to the array of DataLoader objects
@@ -137,11 +142,23 @@ private:
 
     QCPItemLine *loadLine = nullptr;
 
+    QCPLayer *cursorLayer = nullptr; // buffered layer of the cursor and load lines
+
     QPoint lastMousePos;
 
     bool przInverted;
 
-    void update(const QCPRange &range);
+    void update(const QCPRange &range); // synchronous, for callers that read the graph data right after
+
+    void requestUpdate(const QCPRange &range); // asynchronous (pan, zoom, shifts)
+
+    WindowPreparer windowPreparer; // window extraction on a worker thread
+
+    ReplotScheduler replotScheduler; // at most one replot per display frame
+
+    IntervalModel intervalModel; // movement intervals; rectangles and recLabels only draw them
+
+    double intervalHeight {0.0}; // half height of the interval rectangles
 
     QVector<QCPItemRect*> rectangles;
 
@@ -150,6 +167,8 @@ private:
     // private method for adding an interval
     void setRectangle(QCPItemRect *rec, QCPItemText *label);
 
+    void syncIntervalItems(); // fits the rectangles and labels to intervalModel
+
     double deltaPD = 0.0;
 
     double deltaGl = 0.0;
@@ -182,11 +201,11 @@ signals:
 
     void loaderAdded(QString lName);
 
-    void intervalsCreated(QVector<QCPItemRect*> *rectangles);
+    void intervalsCreated(const IntervalModel &intervals);
 
     // signal notifying about movement interval changes
     // connected to DCController::intervalsChanged
-    void intervalsChanged(QVector<QCPItemRect *> intervals);
+    void intervalsChanged(const IntervalModel &intervals);
 
     // signal about curve selection
     void graphSelected(const bool &state, const QString &type);
@@ -217,6 +236,10 @@ private slots:
 
     void moveGl1(const QCPRange &range);
 
+    void windowReady(const QCPRange &range); // slot for the prepared window (WindowPreparer)
+
+    void applyRenderBackend(); // OpenGL or raster, from DCSettings::useOpenGl
+
 public slots:
 
     void updateXAxis(int value);
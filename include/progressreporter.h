@@ -0,0 +1,65 @@
+#ifndef PROGRESSREPORTER_H
+#define PROGRESSREPORTER_H
+
+#include <QElapsedTimer>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+/*
+ * The ProgressReporter class rate-limits progress notifications of long
+ * loops and splits one percentage range between the stages of a pipeline.
+ *
+ * Responsibilities:
+ * - Forward a percentage to a sink only when it has grown and at least
+ *   the minimum interval has passed (100% is always delivered)
+ * - Map nested sub-ranges created with sub() onto the parent range
+ * - Be callable from several threads at once (copies share one state)
+ * - Carry an optional cancellation check for the loops it is passed to
+ */
+class ProgressReporter
+{
+public:
+
+    using Sink = std::function<void(int percent)>;
+
+    // an empty sink disables reporting
+    explicit ProgressReporter(Sink sink = {}, int minIntervalMs = 50);
+
+    // progress of the current range, fraction in [0, 1]
+    void update(double fraction) const;
+
+    void update(qint64 done, qint64 total) const;
+
+    // reports the end of the current range without throttling
+    void finish() const;
+
+    // reporter for the part [from, to] of the current range
+    ProgressReporter sub(double from, double to) const;
+
+    void setCancelCheck(std::function<bool()> check);
+
+    bool isCancelled() const;
+
+private:
+
+    struct State
+    {
+        Sink sink;
+        std::function<bool()> cancelCheck;
+        QElapsedTimer timer;
+        qint64 minInterval {50};
+        std::atomic<int> lastPercent {-1};
+        std::atomic<qint64> lastTime {0};
+    };
+
+    std::shared_ptr<State> state;
+
+    double offset {0.0};    // start of this range in the whole [0, 1]
+
+    double scale {1.0};     // length of this range
+
+    void report(double overall, bool force) const;
+};
+
+#endif // PROGRESSREPORTER_H
@@ -0,0 +1,42 @@
+#ifndef PRZKERNELS_H
+#define PRZKERNELS_H
+
+#include <QtGlobal>
+
+/*
+ * The PrzKernels functions turn the two DVL sensors into the PRZ angle curve.
+ *
+ * Responsibilities:
+ * - Read the four channels once, block by block, and run the sequential
+ *   part of the chain (difference of the sensors, sliding median,
+ *   exponential smoothing, atan2) with the filter states carried across blocks
+ * - Compute atan2 with a rational approximation that is vectorized with AVX
+ *   (selected once at runtime and logged) and accurate to 2 ulp
+ * - Unwrap the phase in two parallel passes: wrap counts per chunk, then
+ *   the prefix sums of the counts applied to every chunk
+ * - Keep the extra memory at a few blocks: the only full-size array is the
+ *   output
+ * - Give the result of running the stages one after another over whole
+ *   arrays with std::atan2, to within floating-point rounding
+ */
+namespace PrzKernels
+{
+    // out[i] = atan2(y[i], x[i]) for finite inputs, within 5e-16 rad (2 ulp);
+    // vectorized with AVX when the CPU has it
+    void atan2(const double *y, const double *x, qsizetype count, double *out);
+
+    // unwraps a phase in place (a jump of more than pi is a wrap) and shifts all samples
+    // but the first one so the minimum is 0; counts the wraps per chunk in parallel,
+    // then applies the prefix sums of the counts in parallel
+    void unwrapFromMinimum(double *phase, qsizetype count);
+
+    // out[i] = unwrapped atan2 of the filtered (x1 - x2, z1 - z2), shifted so its minimum is 0
+    // (except out[0], which keeps its own value as before);
+    // medianRadius < 1 or expAlpha outside (0, 1] skips that filter
+    void dvlAngle(const double *x1, const double *x2,
+                  const double *z1, const double *z2,
+                  qsizetype count, int medianRadius, double expAlpha,
+                  double *out);
+}
+
+#endif // PRZKERNELS_H
@@ -11,7 +11,8 @@
  *
  * Responsibilities:
  * - Store DVL loaders and reference shift points
- * - Compute time correction between DVL channels
+ * - Compute time correction between DVL channels: the four axes are cropped
+ *   in parallel and resampled in place, X and Z of a sensor in one walk
  * - Apply median and exponential smoothing filters
  * - Emit debug output and PRZ creation results
  */
@@ -73,10 +74,6 @@ private:
 
     void timeCorrection();
 
-    void medianFilter(QVector<double>& data, int n);
-
-    void expFilter(QVector<double>& data, double alpha);
-
 signals:
 
     void debug(const QString &text);
@@ -0,0 +1,33 @@
+#ifndef PRZPARSER_H
+#define PRZPARSER_H
+
+#include <QtGlobal>
+
+/*
+ * The PrzParser functions parse the text of a PRZ file directly from a raw
+ * (or memory-mapped) byte buffer without allocating per line.
+ *
+ * Responsibilities:
+ * - Read the start/finish times from the header line
+ * - Convert data rows "<value> <...> <relTime>" into X/Y samples,
+ *   accepting both '.' and ',' as the decimal separator
+ * - Split a buffer into ranges of whole lines
+ */
+namespace PrzParser
+{
+    // parses the header line; returns the offset of the first data row
+    qsizetype parseHeader(const char *data, qsizetype size, double &start, double &finish);
+
+    // upper bound for the number of rows in [begin, end)
+    qsizetype countLines(const char *begin, const char *end);
+
+    // end of the line that contains `pos` (past its '\n'), or `end`
+    const char *lineEnd(const char *pos, const char *end);
+
+    // parses the rows of [begin, end) into X/Y (room for countLines() values);
+    // rows with fewer than 3 fields are skipped. Returns the number of rows written
+    qsizetype parseRows(const char *begin, const char *end, double startPoint,
+                        double *X, double *Y);
+}
+
+#endif // PRZPARSER_H
@@ -0,0 +1,70 @@
+#ifndef REPLOTSCHEDULER_H
+#define REPLOTSCHEDULER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QTimer>
+
+class QCustomPlot;
+
+/*
+ * The ReplotScheduler class coalesces replot requests of a plot so that it
+ * is redrawn at most once per display frame.
+ *
+ * Responsibilities:
+ * - Mark the plot dirty on request() and replot it once when the current
+ *   frame interval (from the screen refresh rate) has elapsed
+ * - Count performed and skipped (coalesced) replots and log them periodically
+ * - Time every replot and keep the mean frame time per backend (raster,
+ *   OpenGL), so the two can be compared on the actual data
+ */
+class ReplotScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    explicit ReplotScheduler(QCustomPlot *plot);
+
+    void request();
+
+    qint64 performedCount() const {return performed;}
+
+    qint64 skippedCount() const {return skipped;}
+
+    double meanFrameMs(bool openGl) const; // 0 if no frame was drawn with that backend
+
+private:
+
+    static constexpr int reportIntervalMs = 10000;
+
+    QCustomPlot *plot;
+
+    QTimer timer;
+
+    QElapsedTimer clock;
+
+    bool dirty {false};
+
+    qint64 lastReplot {-1000};
+
+    qint64 lastReport {0};
+
+    qint64 performed {0};
+
+    qint64 skipped {0};
+
+    struct FrameStats
+    {
+        qint64 frames {0};
+        qint64 nsecs {0};
+    };
+
+    FrameStats stats[2]; // [0] raster, [1] OpenGL
+
+    int frameInterval() const;
+
+    void replotNow();
+};
+
+#endif // REPLOTSCHEDULER_H
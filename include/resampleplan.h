@@ -0,0 +1,79 @@
+#ifndef RESAMPLEPLAN_H
+#define RESAMPLEPLAN_H
+
+#include <QVector>
+#include "timebase.h"
+
+/*
+ * The ResamplePlan class describes a linear resampling onto a uniform grid:
+ * for every output sample, the source sample on its left and the weight of
+ * the next one. The plan depends on the timestamps only, so it is built once
+ * and applied to every channel recorded on them (the X and Z axes of a DV
+ * sensor, say).
+ *
+ * Responsibilities:
+ * - Build the plan from the source timestamps and the target grid in a
+ *   single walk (grid on the multiples of the step, or from the first
+ *   timestamp); the source may be stretched from its first timestamp
+ * - Apply it to a channel as y[j] + w * (y[j + 1] - y[j])
+ * - Stay cheap to keep and copy: the arrays are implicitly shared
+ * - Resample channels in place with a streamed plan when a full-size plan or
+ *   output would double the memory (24 h of DV at 125 Hz)
+ *
+ * The output stops at the first grid point that has no source pair around
+ * it (a gap in the order of the timestamps, or two equal ones).
+ */
+class ResamplePlan
+{
+public:
+
+    ResamplePlan() = default;
+
+    // grid ceil(front / step) * step + k * step up to floor(back / step) * step;
+    // factor != 1 stretches the timestamps from the first one before
+    static ResamplePlan aligned(const TimeBase &X, double step, double factor = 1.0);
+
+    // grid front + k * step up to back
+    static ResamplePlan fromFirst(const TimeBase &X, double step);
+
+    qsizetype size() const {return index.size();}
+
+    bool isEmpty() const {return index.isEmpty();}
+
+    double start() const {return first;}
+
+    double step() const {return dx;}
+
+    qsizetype sourceSize() const {return sources;} // samples a channel must have
+
+    double x(qsizetype k) const {return first + double(k) * dx;}
+
+    TimeBase grid() const {return TimeBase::uniformGrid(first, dx, size());}
+
+    // out = Y on the grid; false (out untouched) if Y does not have sourceSize() samples
+    bool apply(const QVector<double> &Y, QVector<double> &out) const;
+
+    // aligned() without a stored plan: the walk runs block by block and overwrites the channels
+    // (X.size() samples each, all on X) in place, front to back when the grid is sparser than
+    // the source and back to front when it is denser. The extra memory is a few blocks plus the
+    // outputs that wait for their slot (a few samples on a steady timebase, more across a gap in
+    // it). A channel is copied first only if it is shared, and keeps its capacity unless the grid
+    // is less than half as dense. grid receives the result timebase; false (nothing changed) if
+    // a channel has a different size
+    static bool alignedInPlace(const TimeBase &X, double step, double factor,
+                               const QVector<QVector<double> *> &channels, TimeBase &grid);
+
+private:
+
+    double first {0.0};
+
+    double dx {0.0};
+
+    qsizetype sources {0};
+
+    QVector<qsizetype> index;   // left source sample of every output sample
+
+    QVector<double> weight;     // position of the output sample between index and index + 1
+};
+
+#endif // RESAMPLEPLAN_H
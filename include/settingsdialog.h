@@ -35,6 +35,10 @@ private slots:
 
     void on_syncCheckBox_toggled(bool checked);
 
+    void on_cacheCheckBox_toggled(bool checked);
+
+    void on_openGlCheckBox_toggled(bool checked);
+
     void on_dnMedSpinBox_valueChanged(int arg1);
 
     void on_applyButton_clicked();
@@ -0,0 +1,95 @@
+#ifndef SLIDINGMEDIAN_H
+#define SLIDINGMEDIAN_H
+
+#include <QVector>
+#include <vector>
+
+/*
+ * The SlidingMedian class computes a running median over a window of
+ * 2 * radius + 1 samples in O(log w) per sample.
+ *
+ * Responsibilities:
+ * - Keep the window in a ring buffer indexed by two heaps (lower half
+ *   max-heap, upper half min-heap) with incremental insert/evict
+ * - Handle the edges either by repeating the first/last sample (Clamp) or by
+ *   shrinking the window, averaging the two middle values of an even window (Shrink)
+ * - Use a sorting network instead of the heaps for windows up to 7 samples
+ * - Provide a streaming push/flush interface and a whole-array filter()
+ */
+class SlidingMedian
+{
+public:
+
+    enum class Edge
+    {
+        Clamp,
+        Shrink
+    };
+
+    SlidingMedian(int radius, Edge edge);
+
+    int radius() const {return r;}
+
+    // adds the next sample; returns true when the median of an earlier sample is ready
+    bool push(double value, double &median);
+
+    // writes the medians still pending at the end of the data (at most radius()) and resets
+    qsizetype flush(double *out);
+
+    void reset();
+
+    // filters data in place; radius < 1 leaves it unchanged
+    static void filter(QVector<double> &data, int radius, Edge edge);
+
+private:
+
+    static constexpr int networkRadius = 3; // largest radius served by the sorting network
+
+    int r;
+
+    int width;
+
+    Edge edge;
+
+    bool network;
+
+    qint64 pushed {0};          // samples passed to push()
+
+    qint64 oldest {0};          // absolute index of the oldest value in the window
+
+    qint64 next {0};            // absolute index of the next value
+
+    double last {0.0};
+
+    std::vector<double> values; // ring buffer of `width` slots
+
+    std::vector<int> where;     // heap position of a slot: pos in lo, ~pos in hi
+
+    std::vector<int> lo;        // max-heap of slots (lower half)
+
+    std::vector<int> hi;        // min-heap of slots (upper half)
+
+    int size() const {return int(next - oldest);}
+
+    void insert(double value);
+
+    void evict();
+
+    double median() const;
+
+    void rebalance();
+
+    bool before(bool isLo, int a, int b) const;
+
+    void place(std::vector<int> &heap, bool isLo, int pos, int slot);
+
+    void siftUp(std::vector<int> &heap, bool isLo, int pos);
+
+    void siftDown(std::vector<int> &heap, bool isLo, int pos);
+
+    void heapPush(std::vector<int> &heap, bool isLo, int slot);
+
+    void heapRemove(std::vector<int> &heap, bool isLo, int pos);
+};
+
+#endif // SLIDINGMEDIAN_H
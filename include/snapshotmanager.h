@@ -10,6 +10,7 @@
 #include <QThread>
 #include <QMutex>
 #include <atomic>
+#include "timebase.h"
 
 
 class DataLoader;
@@ -26,7 +27,8 @@ public:
     struct loaderInfo
     {
         QString name;
-        QVector<double> X;
+        QVector<double> X;     // empty when grid is uniform
+        TimeBase grid;         // uniform timebase parameters (resampled curves)
         QVector<double> Y;
     };
 
@@ -65,7 +67,8 @@ public:
     struct LoaderInfo
     {
         QString name {""};
-        QVector<double> X;
+        QVector<double> X;     // empty when grid is uniform
+        TimeBase grid;
         QVector<double> Y;
     };
 
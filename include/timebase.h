@@ -0,0 +1,165 @@
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include <QVector>
+#include <iterator>
+
+/*
+ * The TimeBase class is a read-only view of the X (time) column of a curve.
+ * It either refers to an explicit array of timestamps or describes a uniform
+ * grid start + k * step by its parameters only, without storing it. In both
+ * cases an accumulated time shift is added on read.
+ *
+ * Responsibilities:
+ * - Provide QVector-like read access (size, operator[], front/back,
+ *   random-access iterators) for both representations
+ * - Answer lower/upper bound searches in O(1) on a uniform grid
+ * - Apply shifts in O(1) to both representations, and crops to a uniform
+ *   grid, without touching each point
+ * - Materialize the timestamps on request (toVector)
+ *
+ * Uniform values are computed as start + (base + k) * step + offset, i.e. the
+ * same expression resample/timeSync used to store, so they match bit for bit.
+ */
+class TimeBase
+{
+public:
+
+    class const_iterator
+    {
+    public:
+
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = double;
+        using difference_type = qsizetype;
+        using pointer = const double*;
+        using reference = double;
+
+        const_iterator() = default;
+
+        const_iterator(const TimeBase *tb, qsizetype i) : tb(tb), i(i) {}
+
+        double operator*() const {return (*tb)[i];}
+
+        double operator[](difference_type n) const {return (*tb)[i + n];}
+
+        const_iterator &operator++() {++i; return *this;}
+
+        const_iterator operator++(int) {const_iterator t = *this; ++i; return t;}
+
+        const_iterator &operator--() {--i; return *this;}
+
+        const_iterator operator--(int) {const_iterator t = *this; --i; return t;}
+
+        const_iterator &operator+=(difference_type n) {i += n; return *this;}
+
+        const_iterator &operator-=(difference_type n) {i -= n; return *this;}
+
+        const_iterator operator+(difference_type n) const {return const_iterator(tb, i + n);}
+
+        friend const_iterator operator+(difference_type n, const const_iterator &it) {return it + n;}
+
+        const_iterator operator-(difference_type n) const {return const_iterator(tb, i - n);}
+
+        difference_type operator-(const const_iterator &o) const {return i - o.i;}
+
+        bool operator==(const const_iterator &o) const {return i == o.i;}
+
+        bool operator!=(const const_iterator &o) const {return i != o.i;}
+
+        bool operator<(const const_iterator &o) const {return i < o.i;}
+
+        bool operator>(const const_iterator &o) const {return i > o.i;}
+
+        bool operator<=(const const_iterator &o) const {return i <= o.i;}
+
+        bool operator>=(const const_iterator &o) const {return i >= o.i;}
+
+    private:
+
+        const TimeBase *tb {nullptr};
+
+        qsizetype i {0};
+    };
+
+    TimeBase() = default;
+
+    explicit TimeBase(const QVector<double> *values) : values(values) {}
+
+    static TimeBase uniformGrid(double start, double step, qsizetype count);
+
+    // refers to an external array that must outlive the view
+    void setExplicit(const QVector<double> *values);
+
+    void setUniform(double start, double step, qsizetype count);
+
+    // points an explicit view at an equal copy of its array, keeping the shift
+    void rebind(const QVector<double> *values) {if (!uniform) this->values = values;}
+
+    bool isUniform() const {return uniform;}
+
+    qsizetype size() const {return uniform ? count : (values ? values->size() : 0);}
+
+    bool isEmpty() const {return size() == 0;}
+
+    double operator[](qsizetype i) const
+    {
+        return uniform ? first + double(base + i) * dx + offset : (*values)[i] + offset;
+    }
+
+    double at(qsizetype i) const {return (*this)[i];}
+
+    double front() const {return (*this)[0];}
+
+    double back() const {return (*this)[size() - 1];}
+
+    const_iterator begin() const {return const_iterator(this, 0);}
+
+    const_iterator end() const {return const_iterator(this, size());}
+
+    // first index with value >= x / > x (size() if none)
+    qsizetype lowerBound(double x) const;
+
+    qsizetype upperBound(double x) const;
+
+    // index of a timestamp equal to x, -1 if there is none
+    qsizetype indexOf(double x) const;
+
+    QVector<double> toVector() const;
+
+    void shift(double num) {offset += num;}
+
+    // uniform grid only
+    void crop(qsizetype from, qsizetype n) {base += from; count = n;}
+
+    void resize(qsizetype n) {count = n;}
+
+    // grid parameters (for serialization)
+    double gridStart() const {return first;}
+
+    double gridStep() const {return dx;}
+
+    qsizetype gridBase() const {return base;}
+
+    double shiftOffset() const {return offset;} // accumulated shift, both representations
+
+    void setGrid(double start, double step, qsizetype base, double offset, qsizetype count);
+
+private:
+
+    const QVector<double> *values {nullptr};
+
+    bool uniform {false};
+
+    double first {0.0};
+
+    double dx {0.0};
+
+    qsizetype base {0};     // index of the first point on the original grid (after crops)
+
+    double offset {0.0};    // accumulated shift
+
+    qsizetype count {0};
+};
+
+#endif // TIMEBASE_H
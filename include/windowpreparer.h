@@ -0,0 +1,146 @@
+#ifndef WINDOWPREPARER_H
+#define WINDOWPREPARER_H
+
+#include <QObject>
+#include <QCache>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QThreadPool>
+#include <atomic>
+#include <functional>
+#include "qcustomplot.h"
+#include "dataloader.h"
+
+/*
+ * The WindowPreparer class extracts and decimates the visible window of all
+ * curves on a worker thread, so panning does not block the GUI thread.
+ *
+ * Responsibilities:
+ * - Run the window extraction on PlotSource copies of the loaders and fill
+ *   a new QCPGraphDataContainer per graph (already sorted, so it is not
+ *   sorted again), then swap it into the graph on the GUI thread
+ * - Coalesce requests: while a job runs only the latest request is kept
+ * - Snap windows to a grid (width in quarter octaves, start in half widths)
+ *   and keep the recent ones in an LRU, so scrubbing back and forth reuses them
+ * - Track the pan velocity and prepare the next windows in the direction of
+ *   motion while the worker is idle; a prefetch stops after its current
+ *   window as soon as a visible window is requested
+ * - Drop the results of jobs started before invalidate() (curves changed)
+ */
+class WindowPreparer : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    struct Curve
+    {
+        QCPGraph *graph;
+        const DataLoader *loader;
+    };
+
+    explicit WindowPreparer(QObject *parent = nullptr);
+
+    ~WindowPreparer();
+
+    // shows a window covering range; replaces a request still waiting
+    void request(const QVector<Curve> &curves, const QCPRange &range);
+
+    // curves were added, removed or redrawn synchronously: results in flight are stale
+    void invalidate();
+
+    bool isBusy() const {return busy;}
+
+signals:
+
+    // the new data of range is in the graphs (not replotted yet)
+    void ready(const QCPRange &range);
+
+private:
+
+    struct WindowKey
+    {
+        quint64 revision;   // DataLoader::revision(), unique per curve state
+        int level;          // quantized width
+        qint64 slot;        // start in half widths
+
+        bool operator==(const WindowKey &o) const
+        {
+            return revision == o.revision && level == o.level && slot == o.slot;
+        }
+
+        friend size_t qHash(const WindowKey &key, size_t seed = 0)
+        {
+            return qHashMulti(seed, key.revision, key.level, key.slot);
+        }
+    };
+
+    struct Task
+    {
+        int index;          // position in the curve list
+        std::shared_ptr<const PlotSource> source;
+        QCPRange range;
+        WindowKey key;
+        QSharedPointer<QCPGraphDataContainer> data;
+    };
+
+    static constexpr int levelsPerOctave = 4;
+
+    static constexpr int windowsPerCurve = 12;  // LRU size per curve
+
+    static constexpr int maxAhead = 3;          // windows prepared ahead of the motion
+
+    static constexpr int lookaheadMs = 500;
+
+    QThreadPool pool; // one thread: jobs never overlap
+
+    bool busy {false};
+
+    bool hasPending {false};
+
+    std::atomic<bool> interrupt {false}; // a visible window waits: a prefetch job stops early
+
+    QVector<Curve> pendingCurves;
+
+    QCPRange pendingRange;
+
+    quint64 generation {0};
+
+    QCache<WindowKey, QSharedPointer<QCPGraphDataContainer>> cache;
+
+    // pan tracking
+    QElapsedTimer clock;
+
+    qint64 lastTime {-1};
+
+    double lastCenter {0.0};
+
+    QVector<Curve> lastCurves;
+
+    int lastLevel {0};
+
+    qint64 lastSlot {0};
+
+    int direction {0};
+
+    int ahead {1};
+
+    static void quantize(const QCPRange &range, int &level, qint64 &slot);
+
+    static QCPRange window(int level, qint64 slot);
+
+    void trackPan(const QCPRange &range, int level, qint64 slot);
+
+    void show(const QVector<Curve> &curves, const QCPRange &range);
+
+    void prefetch();
+
+    void run(const QVector<Task> &tasks, std::function<void(const QVector<Task> &)> done,
+             bool interruptible = false);
+
+    std::function<void(const QVector<Task> &)> jobDone; // GUI-side completion of the running job
+
+    void finish(quint64 jobGeneration, const QVector<Task> &tasks);
+};
+
+#endif // WINDOWPREPARER_H
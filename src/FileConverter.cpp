@@ -3,6 +3,16 @@
 #include "QTemporaryFile"
 #include <QDir>
 #include <dcsettings.h>
+#include "ifhkernels.h"
+#include "przparser.h"
+#include "datacache.h"
+#include "slidingmedian.h"
+#include "resampleplan.h"
+#include "progressreporter.h"
+#include <cstring>
+#include <atomic>
+#include <QtConcurrent>
+#include <QThread>
 
 // implementation of FileConverter methods
 
@@ -17,6 +27,16 @@ void FileConverter::setWindow(int width)
     this->window = width;
 }
 
+void FileConverter::setCancelCheck(std::function<bool()> check)
+{
+    this->cancelCheck = std::move(check);
+}
+
+bool FileConverter::isCancelled() const
+{
+    return cancelCheck && cancelCheck();
+}
+
 FileConverter::FileConverter(const QString &file_path)
 {
     this->file_path = file_path;
@@ -65,11 +85,27 @@ QString FileConverter::datConvert() // method for converting files to dat. Retur
 void FileConverter::loadFiles()
 {
     this->fileName = QFileInfo(file_path).fileName();
-    QVector<double> X, Y, addY;
+
+    // the columns are decoded straight into the result handed to DCController
+    QSharedPointer<LoadedFile> file = QSharedPointer<LoadedFile>::create();
+    file->fileId = fileName;
+
+    QVector<double> &X = file->X;
+    QVector<double> &Y = file->Y;
+    QVector<double> &addY = file->addY;
+
+    ProgressReporter progress([this](int percent) { emit progressUpdated(fileName, percent); });
+    progress.setCancelCheck(cancelCheck);
 
     if (fileName.endsWith(".prz", Qt::CaseInsensitive))
     {
-        loadPRZ(file_path, X, Y);
+        if (!readCache(X, Y, nullptr, 0))
+        {
+            loadPRZ(file_path, X, Y, progress);
+            writeCache(X, Y, nullptr);
+        }
+
+        if (isCancelled()) return;
 
         if(refFinishPoint - refStartPoint != 0)
         {
@@ -77,16 +113,27 @@ void FileConverter::loadFiles()
         }
 
         double delta = startPoint - refStartPoint;
-        emit progressUpdated(fileName, 100);
-        emit finished(fileName, X, Y, syncFactor, delta);
+        progress.finish();
+        file->syncFactor = syncFactor;
+        file->delta = delta;
+        emit finished(file);
     }
 
     else if (fileName.endsWith(".ifh", Qt::CaseInsensitive)
         && fileName.contains("DN", Qt::CaseInsensitive))
 
     {
-        loadIFH1(file_path, X, Y);
-        medianFilter(Y, DCSettings::instance().getDnMed());
+        const int dnMed = DCSettings::instance().getDnMed();
+
+        if (!readCache(X, Y, nullptr, dnMed))
+        {
+            // progress is split between decoding and the median filter
+            loadIFH1(file_path, X, Y, progress.sub(0.0, 0.5));
+            medianFilter(Y, dnMed, progress.sub(0.5, 1.0));
+            writeCache(X, Y, nullptr);
+        }
+
+        if (isCancelled()) return;
 
         if(refFinishPoint - refStartPoint != 0)
         {
@@ -94,14 +141,22 @@ void FileConverter::loadFiles()
         }
 
         double delta = startPoint - refStartPoint;
-        emit progressUpdated(fileName, 100);
-        emit finished(fileName, X, Y, syncFactor, delta);
+        progress.finish();
+        file->syncFactor = syncFactor;
+        file->delta = delta;
+        emit finished(file);
     }
 
     else if (fileName.endsWith(".ifh", Qt::CaseInsensitive)
              && fileName.contains("DV", Qt::CaseInsensitive))
     {
-        loadIFHdvl(file_path, X, Y, addY);
+        if (!readCache(X, Y, &addY, 0))
+        {
+            loadIFHdvl(file_path, X, Y, addY, progress);
+            writeCache(X, Y, &addY);
+        }
+
+        if (isCancelled()) return;
 
         if(refFinishPoint - refStartPoint != 0)
         {
@@ -110,10 +165,12 @@ void FileConverter::loadFiles()
 
         double delta = startPoint - refStartPoint;
 
-        emit progressUpdated(fileName, 100);
+        progress.finish();
 
-        emit finished(fileName + "_Z", X, Y, syncFactor, delta);
-        emit finished(fileName + "_X", X, addY, syncFactor, delta);
+        file->dualAxis = true;
+        file->syncFactor = syncFactor;
+        file->delta = delta;
+        emit finished(file);
     }
 
     else if (fileName.endsWith(".ifh", Qt::CaseInsensitive)
@@ -121,17 +178,25 @@ void FileConverter::loadFiles()
             || fileName.contains("KM", Qt::CaseInsensitive)))
 
     {
-        loadIFH1(file_path, X, Y);
+        if (!readCache(X, Y, nullptr, 0))
+        {
+            loadIFH1(file_path, X, Y, progress);
+            writeCache(X, Y, nullptr);
+        }
+
+        if (isCancelled()) return;
 
         if(refFinishPoint - refStartPoint != 0)
         {
             syncFactor = (finishPoint - startPoint)/(refFinishPoint - refStartPoint);
         }
 
-        emit progressUpdated(fileName, 100);
+        progress.finish();
         
         double delta = startPoint - refStartPoint;
-        emit finished(fileName, X, Y, syncFactor, delta);
+        file->syncFactor = syncFactor;
+        file->delta = delta;
+        emit finished(file);
     }
 
     else if(fileName.endsWith("fs")
@@ -139,15 +204,19 @@ void FileConverter::loadFiles()
     {
         loadStageFile(file_path, X, Y);
 
+        if (isCancelled()) return;
+
         if(refFinishPoint - refStartPoint != 0)
         {
             syncFactor = (finishPoint - startPoint)/(refFinishPoint - refStartPoint);
         }
 
-        emit progressUpdated(fileName, 100);
+        progress.finish();
 
         double delta = startPoint - refStartPoint;
-        emit finished(fileName, X, Y, syncFactor, delta);
+        file->syncFactor = syncFactor;
+        file->delta = delta;
+        emit finished(file);
     }
 
     else
@@ -158,7 +227,64 @@ void FileConverter::loadFiles()
 
 }
 
-void FileConverter::loadPRZ(const QString &file_path, QVector<double> &X, QVector<double> &Y)
+bool FileConverter::readCache(QVector<double> &X, QVector<double> &Y, QVector<double> *addY,
+                              int filterWindow)
+{
+    if (!DCSettings::instance().getUseCache())
+        return false;
+
+    // hashed once here; writeCache reuses it after a miss
+    cacheSource = DataCache::describe(file_path, filterWindow);
+
+    DataCache::Entry entry;
+
+    if (!DataCache::load(file_path, cacheSource, entry))
+        return false;
+
+    // a DV cache must carry the second axis, other files must not
+    if (entry.addY.isEmpty() != (addY == nullptr))
+        return false;
+
+    X = std::move(entry.X);
+    Y = std::move(entry.Y);
+
+    if (addY)
+        *addY = std::move(entry.addY);
+
+    startPoint = entry.startPoint;
+    finishPoint = entry.finishPoint;
+    refStartPoint = entry.refStartPoint;
+    refFinishPoint = entry.refFinishPoint;
+
+    qDebug() << "file" << fileName << "loaded from cache";
+    return true;
+}
+
+void FileConverter::writeCache(const QVector<double> &X, const QVector<double> &Y,
+                               const QVector<double> *addY)
+{
+    // a cancelled load leaves incomplete columns
+    if (!DCSettings::instance().getUseCache() || X.isEmpty() || isCancelled())
+        return;
+
+    DataCache::Entry entry;
+
+    entry.X = X;    // shared, not copied
+    entry.Y = Y;
+
+    if (addY)
+        entry.addY = *addY;
+
+    entry.startPoint = startPoint;
+    entry.finishPoint = finishPoint;
+    entry.refStartPoint = refStartPoint;
+    entry.refFinishPoint = refFinishPoint;
+
+    DataCache::store(file_path, cacheSource, entry);
+}
+
+void FileConverter::loadPRZ(const QString &file_path, QVector<double> &X, QVector<double> &Y,
+                            const ProgressReporter &progress)
 {
     if (file_path == ""){       // if the path is empty
         qWarning() << "Empty path passed to FileConverter";      // error signal is sent (can be replaced by qWarning)
@@ -168,7 +294,7 @@ void FileConverter::loadPRZ(const QString &file_path, QVector<double> &X, QVecto
     QFile prz(file_path); // create an object for the source prz file
     QString fileName = QFileInfo(file_path).fileName();
 
-    emit progressUpdated(fileName, 0);
+    progress.update(0.0);
 
     if (!prz.open(QIODevice::ReadOnly)) // open file
     {
@@ -176,71 +302,126 @@ void FileConverter::loadPRZ(const QString &file_path, QVector<double> &X, QVecto
         return;
     }
 
-    else {
+    // the text is parsed in place from the mapped view;
+    // if mapping is not available it is read in one call
+    QByteArray buffer;
+    qint64 size = prz.size();
+    uchar *mapped = prz.map(0, size);
+    const char *data = reinterpret_cast<const char*>(mapped);
 
-        QFileInfo fi(file_path);
-        int approxPoints =  fi.size() / 39;
+    if (mapped == nullptr)
+    {
+        buffer = prz.readAll();
+        data = buffer.constData();
+        size = buffer.size();
+    }
 
-        X.reserve(approxPoints);
-        Y.reserve(approxPoints);
+    X.clear();
+    Y.clear();
 
-        QString line; // variable for reading a line from the prz file
-        QStringList data; // list for storing numbers from a line (QString)
-        double num1, num2;      // num1 - time, num2 - radians
+    const char *end = data + size;
+    const char *pos = data + PrzParser::parseHeader(data, size, startPoint, finishPoint);
 
-        QTextStream in(&prz);  // stream for reading the prz file
+    // the body is split on line boundaries into chunks that are parsed
+    // concurrently straight into their place in X/Y
+    struct Chunk
+    {
+        const char *begin;
+        const char *end;
+        qsizetype lines {0};    // upper bound of rows, i.e. reserved slots
+        qsizetype offset {0};   // first slot of the chunk
+        qsizetype written {0};  // rows actually parsed
+    };
 
-        X.clear();
-        Y.clear();
+    constexpr qint64 minChunk = 1 << 20; // smaller chunks are not worth a task
 
-        line = in.readLine();   // read the first line
-        data = line.split(" "); // split by spaces
-        startPoint = data[0].toDouble(); // start time
-        finishPoint = data[2].toDouble(); // finish time
+    const qint64 body = end - pos;
+    const int chunkCount = int(qBound<qint64>(1, body / minChunk, QThread::idealThreadCount()));
 
+    QVector<Chunk> chunks;
+    chunks.reserve(chunkCount);
 
-        int delta = static_cast<int>(startPoint) % 1000;
-        int lastSec = -1;
+    for (int i = 0; i < chunkCount && pos < end; i++)
+    {
+        const char *chunkEnd = (i == chunkCount - 1)
+                                   ? end
+                                   : PrzParser::lineEnd(pos + qMax<qint64>(body / chunkCount, 1) - 1, end);
 
-        int k = 0;
+        chunks.append({pos, chunkEnd});
+        pos = chunkEnd;
+    }
 
-        while (!in.atEnd()) // until end of file
-        {
+    // 1. count lines to know where every chunk starts
+    QtConcurrent::blockingMap(chunks, [](Chunk &c) {
+        c.lines = PrzParser::countLines(c.begin, c.end);
+    });
 
-            line = in.readLine();   // read a new line
+    qsizetype lines = 0;
+    for (Chunk &c : chunks)
+    {
+        c.offset = lines;
+        lines += c.lines;
+    }
 
-            data = line.split(" ", Qt::SkipEmptyParts); // split by spaces
-            num2 = data[0].replace(',', '.').toDouble();   // radians (first number)
-            int relTime = data[2].toInt();
-            double curSec = relTime / 1000.0 + static_cast<int>(startPoint / 1000);
+    X.resize(lines);
+    Y.resize(lines);
 
-            X.append(curSec);
-            Y.append(num2);
+    // 2. parse; progress is aggregated over the bytes of all chunks
+    constexpr qint64 slice = 1 << 20; // bytes parsed between progress updates
 
-            k++;
+    double *xData = X.data();
+    double *yData = Y.data();
+    std::atomic<qint64> parsed {0};
 
-            if(k % 800 == 0)
-            {
-                emit progressUpdated(fileName,  k * 100 / approxPoints);
-            }
+    QtConcurrent::blockingMap(chunks, [&](Chunk &c) {
+        const char *from = c.begin;
+
+        while (from < c.end && !progress.isCancelled())
+        {
+            const char *sliceEnd = PrzParser::lineEnd(from + qMin<qint64>(slice, c.end - from) - 1, c.end);
+
+            c.written += PrzParser::parseRows(from, sliceEnd, startPoint,
+                                              xData + c.offset + c.written,
+                                              yData + c.offset + c.written);
+
+            progress.update(parsed.fetch_add(sliceEnd - from) + (sliceEnd - from), body);
+            from = sliceEnd;
+        }
+    });
+
+    // 3. close the gaps left by skipped lines
+    qsizetype k = 0;
+    for (const Chunk &c : chunks)
+    {
+        if (c.offset != k)
+        {
+            memmove(xData + k, xData + c.offset, c.written * sizeof(double));
+            memmove(yData + k, yData + c.offset, c.written * sizeof(double));
         }
+
+        k += c.written;
     }
 
+    X.resize(k);
+    Y.resize(k);
+
     X.squeeze();
     Y.squeeze();
 
+    if (mapped)
+        prz.unmap(mapped);
+
     prz.close();
     qDebug() << "file" << fileName << "loaded into FileConverter";
 }
 
-void FileConverter::loadIFH1(const QString &file_path, QVector<double> &X, QVector<double> &Y)
+void FileConverter::loadIFH1(const QString &file_path, QVector<double> &X, QVector<double> &Y,
+                             const ProgressReporter &progress)
 {
     qDebug() << "window width:" << window;
 
     int step = 8;
 
-    int frame = 16;
-
     if (file_path == "") // if the path is empty
     {
         qWarning() << "Empty path passed to FileConverter";;      // log the error
@@ -252,7 +433,7 @@ void FileConverter::loadIFH1(const QString &file_path, QVector<double> &X, QVect
     if(fileName.contains("DN", Qt::CaseInsensitive))
         step = 100;
 
-    emit progressUpdated(fileName, 0);
+    progress.update(0.0);
 
     QFile ifh(file_path); // create object for the source ifh file
 
@@ -262,144 +443,25 @@ void FileConverter::loadIFH1(const QString &file_path, QVector<double> &X, QVect
         return;
     }
 
-    else {
-
-        const int approxPoints = int(ifh.size() / frame);
-        X.clear();
-        Y.clear();
-        X.reserve(approxPoints);
-        Y.reserve(approxPoints);
-
-        char buf[frame]; // buffer for reading bytes
-
-        QDataStream in(&ifh);  // stream for reading the ifh file
-        // QQueue<double> q;
-
-        X.clear();
-        Y.clear();
-
-        int msCount = 1000;
-        unsigned k = 0;
-        double lastSec = 0.0;
-        // QQueue<double> xq;
-
-        while (!in.atEnd() && ifh.bytesAvailable() >= frame)
-        {
-            if (ifh.read(buf, frame) != frame) break;
-            const quint8* b = reinterpret_cast<const quint8*>(buf);
-
-            // [0..2] sec (3 bytes)
-            quint32 sec  = (quint32(b[0]) << 16) | (quint32(b[1]) << 8) | quint32(b[2]);
-            // [3..4] msec (2 bytes)
-            if(k == 0)
-                msCount = (quint32(b[3]) << 8)  | quint32(b[4]);
-
-            // [5..6] skip 2 bytes
-            // [10..12] skip 3 bytes
-            // [13..15] Z axis (3 bytes, signed)
-            qint32 numRaw = (qint32(b[13]) << 16) | (qint32(b[14]) << 8) | qint32(b[15]);
-            if (b[13] & 0x80) numRaw |= 0xFF000000;
-
-
-            if (std::all_of(reinterpret_cast<const quint8*>(buf),
-                            reinterpret_cast<const quint8*>(buf) + frame,
-                            [](quint8 v){ return v == 0xFF; }))
-            {
-                break;
-            }
-
-            if((double(sec) > lastSec && msCount == 1000) || k == 0)
-            {
-                msCount = 0;
-                lastSec = double(sec);
-            }
-
-            else if(double(sec) > lastSec && msCount <= 1000)
-            {
-                while (msCount < 1000)
-                {
-                    X.append(lastSec + double(msCount) / 1000.0);
-                    Y.append(Y.back());
-
-                    msCount += step;
-                }
-
-                msCount = 0;
-                lastSec = sec;
-            }
-
-            if(msCount >= 1000) continue;
-
-
-            double time = double(sec) + double(msCount) / 1000.0;
-            double num = double(numRaw);
-
-            k++;
-
-            X.append(time);  // store without filtering
-            Y.append(num);
-
-            msCount += step;
-
-            if(k % 100000 == 0)
-            {
-                if(fileName.contains("DN", Qt::CaseInsensitive))
-                    emit progressUpdated(fileName,  k * 50.0 / approxPoints);
-                else
-                    emit progressUpdated(fileName,  k * 100.0 / approxPoints);
-            }
-                
-        }
-
-        X.squeeze();
-        Y.squeeze();
-
-        bool flag = true;
-        ifh.seek(ifh.size() - 61);
-        for (int i = 0; i < 5; i++){
-            if(!in.atEnd()){
-                in >> buf[i];
-            }
-            else break;
-            if (buf[i] != '#') {flag = false; break;}
-        }
-
-        if (flag)
-        {
-            QRegularExpression datePattern(R"((\d{2}\.\d{2}\.\d{4} \d{2}:\d{2}:\d{2}))"); // date/time pattern
-            for (int i = 0; i < 2; i ++){
-                QByteArray data = ifh.read(20); // read 20 bytes into an array
-                QString text = QString::fromLatin1(data); // convert to string
-
-                if(i == 0)
-                    qDebug() << "START TIME:" << text;
-                else
-                    qDebug() << "END TIME:" << text;
+    // the whole file is decoded in place from the mapped view;
+    // if mapping is not available it is read in one call
+    QByteArray buffer;
+    qint64 size = ifh.size();
+    uchar *mapped = ifh.map(0, size);
+    const uchar *data = mapped;
 
-                QRegularExpressionMatch match = datePattern.match(text); // find matches
-                if (match.hasMatch())
-                {
-                    QString dateString = match.captured(1);
-                    QDateTime dateTime = QDateTime::fromString(dateString, "dd.MM.yyyy HH:mm:ss");
-                    dateTime = dateTime.toUTC();  // convert to UTC
+    if (mapped == nullptr)
+    {
+        buffer = ifh.readAll();
+        data = reinterpret_cast<const uchar*>(buffer.constData());
+        size = buffer.size();
+    }
 
-                    if (i == 0)
-                        startPoint = dateTime.toSecsSinceEpoch();
-                    else if (i == 1)
-                        finishPoint = dateTime.toSecsSinceEpoch();
+    decodeIFH(data, size, step, progress, X, Y, nullptr);
+    readIFHTrailer(data, size);
 
-                    ifh.seek(ifh.pos() + 2);
-                    data = ifh.read(6);
-                    text = QString::fromLatin1(data);
-                    bool ok;
-                    if (i == 0)
-                        refStartPoint = text.toUInt(&ok,16);
-                    else
-                        refFinishPoint = text.toUInt(&ok,16);
-                }
-            }
-        }
-    }
+    if (mapped)
+        ifh.unmap(mapped);
 
     ifh.close();
     qDebug() << "файл" << fileName << "загружен в DataLoader";
@@ -407,10 +469,9 @@ void FileConverter::loadIFH1(const QString &file_path, QVector<double> &X, QVect
     qDebug() << "X.back() - X.front():" << X.back() - X.front();
 }
 
-void FileConverter::loadIFHdvl(const QString &file_path, QVector<double> &X, QVector<double> &Y, QVector<double> &addY)
+void FileConverter::loadIFHdvl(const QString &file_path, QVector<double> &X, QVector<double> &Y, QVector<double> &addY,
+                               const ProgressReporter &progress)
 {
-    int dvlWindow = 0, frame = 16;
-
     if (file_path == "") // if the path is empty
     {
         qWarning() << "В FileConverter передан пустой путь";;      // log the error
@@ -419,7 +480,7 @@ void FileConverter::loadIFHdvl(const QString &file_path, QVector<double> &X, QVe
 
     QString fileName = QFileInfo(file_path).fileName();
 
-    emit progressUpdated(fileName, 0);
+    progress.update(0.0);
 
     QFile ifh(file_path); // create object for the source ifh file
 
@@ -429,56 +490,88 @@ void FileConverter::loadIFHdvl(const QString &file_path, QVector<double> &X, QVe
         return;
     }
 
-    else {
+    QByteArray buffer;
+    qint64 size = ifh.size();
+    uchar *mapped = ifh.map(0, size);
+    const uchar *data = mapped;
+
+    if (mapped == nullptr)
+    {
+        buffer = ifh.readAll();
+        data = reinterpret_cast<const uchar*>(buffer.constData());
+        size = buffer.size();
+    }
 
-        const int approxPoints = int(ifh.size() / frame);
-        X.clear();
-        Y.clear();
-        X.reserve(approxPoints);
-        Y.reserve(approxPoints);
-        addY.reserve(approxPoints);
+    decodeIFH(data, size, 8, progress, X, Y, &addY);
+    readIFHTrailer(data, size);
 
-        char buf[frame]; // buffer for reading bytes
+    if (mapped)
+        ifh.unmap(mapped);
 
-        QDataStream in(&ifh);  // stream for reading the ifh file
-       // QQueue<double> q;
+    ifh.close();
+    qDebug() << "файл" << fileName << "загружен в DataLoader";
+    qDebug() << "X.size():" << X.size();
+    qDebug() << "X.back() - X.front():" << X.back() - X.front();
+}
 
-        X.clear();
-        Y.clear();
+// decodes 16-byte IFH frames from a memory buffer
+// step - sample period in ms; addY - X axis of DVL files (nullptr for DN/MK)
+void FileConverter::decodeIFH(const uchar *data, qint64 size, int step, const ProgressReporter &progress,
+                              QVector<double> &X, QVector<double> &Y, QVector<double> *addY)
+{
+    constexpr int frame = IfhKernels::frameSize;
+    constexpr qint64 block = 1024; // frames decoded by one kernel call
 
-        int msCount = 1000;
-        unsigned k = 0;
-        double lastSec = 0.0;
-       // QQueue<double> xq;
+    const qint64 frames = size / frame;
+    const int approxPoints = int(frames);
 
-        while (!in.atEnd() && ifh.bytesAvailable() >= frame)
-        {
-            if (ifh.read(buf, frame) != frame) break;
-            const quint8* b = reinterpret_cast<const quint8*>(buf);
+    X.clear();
+    Y.clear();
+    X.reserve(approxPoints);
+    Y.reserve(approxPoints);
 
-            // [0..2] sec (3 bytes)
-            quint32 sec  = (quint32(b[0]) << 16) | (quint32(b[1]) << 8) | quint32(b[2]);
-            // [3..4] msec (2 bytes)
-            if(k == 0)
-                msCount = (quint32(b[3]) << 8)  | quint32(b[4]);
+    if (addY)
+    {
+        addY->clear();
+        addY->reserve(approxPoints);
+    }
+
+    double zBlock[block], xBlock[block]; // decoded axes of the current block
 
-            // [5..6] skip 2 bytes
-            // [7..9] X axis (3 bytes, signed)
-            qint32 xNumRaw = (qint32(b[7]) << 16) | (qint32(b[8]) << 8) | qint32(b[9]);
-            if (b[7] & 0x80) xNumRaw |= 0xFF000000;
-            // [10..12] skip 3 bytes
-            // [13..15] Z axis (3 bytes, signed)
-            qint32 zNumRaw = (qint32(b[13]) << 16) | (qint32(b[14]) << 8) | qint32(b[15]);
-            if (b[13] & 0x80) zNumRaw |= 0xFF000000;
+    int msCount = 1000;
+    unsigned k = 0;
+    double lastSec = 0.0;
+    bool endOfData = false;
 
+    for (qint64 first = 0; first < frames && !endOfData && !progress.isCancelled(); first += block)
+    {
+        const qint64 count = qMin(block, frames - first);
+        const uchar *blockData = data + first * frame;
 
-            if (std::all_of(reinterpret_cast<const quint8*>(buf),
-                            reinterpret_cast<const quint8*>(buf) + frame,
-                            [](quint8 v){ return v == 0xFF; }))
+        // [7..9] X axis, [13..15] Z axis (3 bytes, signed)
+        IfhKernels::extractAxes(blockData, count, zBlock, addY ? xBlock : nullptr);
+
+        for (qint64 j = 0; j < count; j++)
+        {
+            const uchar *b = blockData + j * frame;
+
+            // end of data: the whole frame is filled with 0xFF
+            quint64 head, tail;
+            memcpy(&head, b, sizeof(head));
+            memcpy(&tail, b + sizeof(head), sizeof(tail));
+
+            if (head == ~quint64(0) && tail == ~quint64(0))
             {
+                endOfData = true;
                 break;
             }
 
+            // [0..2] sec (3 bytes)
+            quint32 sec  = (quint32(b[0]) << 16) | (quint32(b[1]) << 8) | quint32(b[2]);
+            // [3..4] msec (2 bytes)
+            if(k == 0)
+                msCount = (quint32(b[3]) << 8)  | quint32(b[4]);
+
             if((double(sec) > lastSec && msCount == 1000) || k == 0)
             {
                 msCount = 0;
@@ -490,11 +583,12 @@ void FileConverter::loadIFHdvl(const QString &file_path, QVector<double> &X, QVe
                 while (msCount < 1000)
                 {
                     X.append(lastSec + double(msCount) / 1000.0);
-
                     Y.append(Y.back());
-                    addY.append(addY.back());
 
-                    msCount += 8;
+                    if (addY)
+                        addY->append(addY->back());
+
+                    msCount += step;
                 }
 
                 msCount = 0;
@@ -503,110 +597,114 @@ void FileConverter::loadIFHdvl(const QString &file_path, QVector<double> &X, QVe
 
             if(msCount >= 1000) continue;
 
-
-            double time = double(sec) + double(msCount) / 1000.0;
-            double xNum = double(xNumRaw);
-            double zNum = double(zNumRaw);
-
             k++;
 
-            if (dvlWindow == 0)
-            {
-                X.append(time);  // store without filtering
-                Y.append(zNum);
-                addY.append(xNum);
+            X.append(double(sec) + double(msCount) / 1000.0);  // store without filtering
+            Y.append(zBlock[j]);
 
-                msCount += 8;
+            if (addY)
+                addY->append(xBlock[j]);
 
-                if(k % 100000 == 0)
-                {
-                    emit progressUpdated(fileName,  k * 100 / approxPoints);
-                }
-
-                continue;
-            }
+            msCount += step;
         }
 
-        X.squeeze();
-        Y.squeeze();
-        addY.squeeze();
+        progress.update(first + count, frames);
+    }
 
-        bool flag = true;
-        ifh.seek(ifh.size() - 61);
-        for (int i = 0; i < 5; i++){
-            if(!in.atEnd()){
-                in >> buf[i];
-            }
-            else break;
-            if (buf[i] != '#') {flag = false; break;}
-        }
+    X.squeeze();
+    Y.squeeze();
 
-        if (flag)
-        {
-            QRegularExpression datePattern(R"((\d{2}\.\d{2}\.\d{4} \d{2}:\d{2}:\d{2}))"); // date/time pattern
-            for (int i = 0; i < 2; i ++){
-                QByteArray data = ifh.read(20); // read 20 bytes into an array
-                QString text = QString::fromLatin1(data); // convert to string
+    if (addY)
+        addY->squeeze();
+}
 
-                if(i == 0)
-                    qDebug() << "START TIME:" << text;
-                else
-                    qDebug() << "END TIME:" << text;
+// reads the text trailer of an IFH file (last 61 bytes):
+// "#####", then start and finish records - 20 bytes of date/time,
+// 2 skipped bytes and 6 bytes of the reference time in hex
+void FileConverter::readIFHTrailer(const uchar *data, qint64 size)
+{
+    constexpr qint64 trailerSize = 61;
 
-                QRegularExpressionMatch match = datePattern.match(text); // find matches
-                if (match.hasMatch())
-                {
-                    QString dateString = match.captured(1);
-                    QDateTime dateTime = QDateTime::fromString(dateString, "dd.MM.yyyy HH:mm:ss");
-                    dateTime = dateTime.toUTC();  // convert to UTC
+    if (size < trailerSize) return;
 
-                    if (i == 0)
-                        startPoint = dateTime.toSecsSinceEpoch();
-                    else if (i == 1)
-                        finishPoint = dateTime.toSecsSinceEpoch();
+    qint64 pos = size - trailerSize;
 
-                    ifh.seek(ifh.pos() + 2);
-                    data = ifh.read(6);
-                    text = QString::fromLatin1(data);
-                    bool ok;
-                    if (i == 0)
-                        refStartPoint = text.toUInt(&ok,16);
-                    else
-                        refFinishPoint = text.toUInt(&ok,16);
-                }
-            }
-        }
+    for (int i = 0; i < 5; i++, pos++)
+    {
+        if (data[pos] != '#') return;
     }
 
-    ifh.close();
-    qDebug() << "файл" << fileName << "загружен в DataLoader";
-    qDebug() << "X.size():" << X.size();
-    qDebug() << "X.back() - X.front():" << X.back() - X.front();
+    // reads up to n bytes from the current position
+    auto read = [&](qint64 n)
+    {
+        n = qMin(n, size - pos);
+        QString text = QString::fromLatin1(reinterpret_cast<const char*>(data + pos), n);
+        pos += n;
+        return text;
+    };
+
+    QRegularExpression datePattern(R"((\d{2}\.\d{2}\.\d{4} \d{2}:\d{2}:\d{2}))"); // date/time pattern
+    for (int i = 0; i < 2; i ++){
+        QString text = read(20); // read 20 bytes
+
+        if(i == 0)
+            qDebug() << "START TIME:" << text;
+        else
+            qDebug() << "END TIME:" << text;
+
+        QRegularExpressionMatch match = datePattern.match(text); // find matches
+        if (match.hasMatch())
+        {
+            QString dateString = match.captured(1);
+            QDateTime dateTime = QDateTime::fromString(dateString, "dd.MM.yyyy HH:mm:ss");
+            dateTime = dateTime.toUTC();  // convert to UTC
+
+            if (i == 0)
+                startPoint = dateTime.toSecsSinceEpoch();
+            else if (i == 1)
+                finishPoint = dateTime.toSecsSinceEpoch();
+
+            pos = qMin(pos + 2, size);
+            text = read(6);
+            bool ok;
+            if (i == 0)
+                refStartPoint = text.toUInt(&ok,16);
+            else
+                refFinishPoint = text.toUInt(&ok,16);
+        }
+    }
 }
 
-void FileConverter::medianFilter(QVector<double> &data, int radius)
+void FileConverter::medianFilter(QVector<double> &data, int radius, const ProgressReporter &progress)
 {
     if (data.isEmpty() || radius < 1) return;
 
+    constexpr qsizetype block = 1 << 16; // samples between progress updates
+
+    SlidingMedian median(radius, SlidingMedian::Edge::Clamp);
     QVector<double> result(data.size());
 
-    for (int i = 0; i < data.size(); ++i)
+    const qsizetype n = data.size();
+    double *out = result.data();
+    qsizetype k = 0;
+
+    for (qsizetype first = 0; first < n; first += block)
     {
-        QVector<double> window;
-        for (int j = -radius; j <= radius; ++j)
+        if (progress.isCancelled()) return;
+
+        const qsizetype last = qMin(first + block, n);
+
+        for (qsizetype i = first; i < last; ++i)
         {
-            int idx = i + j;
-            if (idx < 0) idx = 0;
-            if (idx >= data.size()) idx = data.size() - 1;
-            window.append(data[idx]);
+            if (median.push(data[i], out[k]))
+                k++;
         }
 
-        std::sort(window.begin(), window.end());
-        result[i] = window[radius];
-
-        emit progressUpdated(fileName,  50.0 + double(i) * 100 / data.size() / 2);
+        progress.update(last, n);
     }
 
+    median.flush(out + k);
+
     data.swap(result);
 }
 
@@ -708,35 +806,11 @@ void FileConverter::resample(const QVector<double> &X, const QVector<double> &Y,
     resX.clear();
     resY.clear();
 
-    double start  = std::ceil(X.front() / step) * step;
-    double finish = std::floor(X.back() / step) * step;
-    int length = std::floor((finish - start) / step) + 1;
+    const ResamplePlan plan = ResamplePlan::aligned(TimeBase(&X), step);
 
-    resX.reserve(length);
-    resY.reserve(length);
+    if(!plan.apply(Y, resY)) return;
 
-    int k = 0, j = 0;
-
-    while(start + k * step <= finish)
-    {
-        double x = start + k * step;
-        double y;
-
-        while(j < X.size() - 1 && x > X[j + 1])
-            j++;
-
-        if(j + 1 > X.size() - 1) break;
-
-        if(x >= X[j] && x <= X[j + 1] && (X[j + 1] - X[j]) != 0)
-            y = Y[j] + (x - X[j]) / (X[j + 1] - X[j]) * (Y[j + 1] - Y[j]);
-        else
-            break;
-
-        resX.append(x);
-        resY.append(y);
-
-        k++;
-    }
+    resX = plan.grid().toVector();
 }
 
 
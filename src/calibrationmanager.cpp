@@ -1,4 +1,5 @@
 #include "calibrationmanager.h"
+#include "slidingmedian.h"
 
 CalibrationManager::CalibrationManager(QObject *parent)
     : QObject{parent}
@@ -246,23 +247,8 @@ QVector<double> CalibrationManager::medianFilter(const QVector<double> &data, in
     if (windowSize % 2 == 0)
         windowSize++; // окно должно быть нечётным
 
-    int radius = windowSize / 2;
-    QVector<double> result(data.size());
-
-    for (int i = 0; i < data.size(); ++i)
-    {
-        QVector<double> window;
-        for (int j = -radius; j <= radius; ++j)
-        {
-            int idx = i + j;
-            if (idx < 0) idx = 0;
-            if (idx >= data.size()) idx = data.size() - 1;
-            window.append(data[idx]);
-        }
-
-        std::sort(window.begin(), window.end());
-        result[i] = window[radius];
-    }
+    QVector<double> result = data;
+    SlidingMedian::filter(result, windowSize / 2, SlidingMedian::Edge::Clamp);
 
     return result;
 }
@@ -0,0 +1,63 @@
+#include "cpufeatures.h"
+#include <QDebug>
+
+#if defined(CPU_FEATURES_X86) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+bool CpuFeatures::hasSsse3()
+{
+#ifndef CPU_FEATURES_X86
+    return false;
+#elif defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    return info[2] & (1 << 9);
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("ssse3");
+#endif
+}
+
+bool CpuFeatures::hasAvx()
+{
+#ifndef CPU_FEATURES_X86
+    return false;
+#elif defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+
+    __cpuid(info, 1);
+    const bool osxsave = info[2] & (1 << 27);
+    const bool avx = info[2] & (1 << 28);
+    if (!osxsave || !avx) return false;
+
+    // the OS must save the YMM registers
+    return (_xgetbv(0) & 0x6) == 0x6;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx");
+#endif
+}
+
+bool CpuFeatures::hasAvx2()
+{
+#ifndef CPU_FEATURES_X86
+    return false;
+#elif defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+
+    __cpuid(info, 0);
+    if (info[0] < 7 || !hasAvx()) return false;
+
+    __cpuidex(info, 7, 0);
+    return info[1] & (1 << 5);
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+void CpuFeatures::logSelected(const char *what, const char *name)
+{
+    qDebug() << what << "kernel:" << name;
+}
@@ -0,0 +1,212 @@
+#include "datacache.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QDebug>
+#include <cstring>
+#include <type_traits>
+
+namespace
+{
+
+constexpr quint32 cacheMagic = 0x48434344; // "DCCH"
+constexpr quint32 cacheVersion = 2; // 1 hashed only both ends of the source
+constexpr qint64 hashBlock = 1 << 20; // bytes of the source read per call while hashing
+
+// fixed-size header at the start of the cache, followed by `columns` arrays of `count` doubles
+struct Header
+{
+    quint32 magic;
+    quint32 version;
+    qint64 sourceSize;
+    qint64 sourceMtime;      // ms since epoch
+    quint64 fingerprint;
+    qint32 filterWindow;
+    qint32 columns;          // 2 (X, Y) or 3 (X, Y, addY)
+    qint64 count;
+    double startPoint;
+    double finishPoint;
+    double refStartPoint;
+    double refFinishPoint;
+};
+
+static_assert(std::is_trivially_copyable_v<Header>);
+
+constexpr quint64 hashPrime = 0x100000001B3ull;
+
+// FNV-1a over 64-bit words, the tail byte by byte; every step is a bijection of the
+// state, so a change confined to one word always changes the hash
+void hashBytes(quint64 &hash, const char *data, qint64 size)
+{
+    qint64 i = 0;
+
+    for (; i + 8 <= size; i += 8)
+    {
+        quint64 word;
+        memcpy(&word, data + i, sizeof(word));
+
+        hash = (hash ^ word) * hashPrime;
+        hash ^= hash >> 32;
+    }
+
+    for (; i < size; i++)
+    {
+        hash ^= uchar(data[i]);
+        hash *= hashPrime;
+    }
+}
+
+// hash of the whole source: an edit anywhere invalidates the cache even when the size
+// and mtime are kept (a copy that preserves timestamps). It reads at the speed of the
+// page cache, a small part of the parse it saves
+bool sourceFingerprint(const QString &sourcePath, quint64 &hash)
+{
+    QFile src(sourcePath);
+
+    if (!src.open(QIODevice::ReadOnly))
+        return false;
+
+    hash = 0xCBF29CE484222325ull;
+
+    QByteArray block(hashBlock, Qt::Uninitialized);
+    qint64 n;
+
+    while ((n = src.read(block.data(), hashBlock)) > 0)
+        hashBytes(hash, block.constData(), n);
+
+    return n == 0;
+}
+
+Header sourceHeader(const DataCache::Source &source)
+{
+    Header h {};
+    h.magic = cacheMagic;
+    h.version = cacheVersion;
+    h.sourceSize = source.size;
+    h.sourceMtime = source.mtime;
+    h.fingerprint = source.fingerprint;
+    h.filterWindow = source.filterWindow;
+
+    return h;
+}
+
+} // namespace
+
+QString DataCache::cachePath(const QString &sourcePath)
+{
+    return sourcePath + ".dccache";
+}
+
+DataCache::Source DataCache::describe(const QString &sourcePath, int filterWindow)
+{
+    QFileInfo info(sourcePath);
+    Source source;
+
+    if (!info.exists() || !sourceFingerprint(sourcePath, source.fingerprint))
+        return source;
+
+    source.size = info.size();
+    source.mtime = info.lastModified().toMSecsSinceEpoch();
+    source.filterWindow = filterWindow;
+
+    return source;
+}
+
+bool DataCache::load(const QString &sourcePath, const Source &source, Entry &entry)
+{
+    if (!source.isValid())
+        return false;
+
+    QFile cache(cachePath(sourcePath));
+
+    if (!cache.exists() || !cache.open(QIODevice::ReadOnly))
+        return false;
+
+    const Header expected = sourceHeader(source);
+
+    // the columns are read straight into their arrays; they cannot alias a read-only
+    // mapping of the cache, the loaders modify them (timeSync resamples in place)
+    const qint64 size = cache.size();
+    Header h;
+
+    bool valid = cache.read(reinterpret_cast<char*>(&h), sizeof(Header)) == qint64(sizeof(Header))
+                 && h.magic == expected.magic
+                 && h.version == expected.version
+                 && h.sourceSize == expected.sourceSize
+                 && h.sourceMtime == expected.sourceMtime
+                 && h.fingerprint == expected.fingerprint
+                 && h.filterWindow == expected.filterWindow
+                 && (h.columns == 2 || h.columns == 3)
+                 && h.count >= 0
+                 && size == qint64(sizeof(Header)) + h.count * h.columns * qint64(sizeof(double));
+
+    if (valid)
+    {
+        const qint64 bytes = h.count * qint64(sizeof(double));
+
+        auto readColumn = [&](QVector<double> &column)
+        {
+            column.resize(h.count);
+            return cache.read(reinterpret_cast<char*>(column.data()), bytes) == bytes;
+        };
+
+        entry.addY.clear();
+
+        valid = readColumn(entry.X)
+                && readColumn(entry.Y)
+                && (h.columns == 2 || readColumn(entry.addY));
+
+        entry.startPoint = h.startPoint;
+        entry.finishPoint = h.finishPoint;
+        entry.refStartPoint = h.refStartPoint;
+        entry.refFinishPoint = h.refFinishPoint;
+    }
+
+    if (!valid)
+        qDebug() << "cache" << cache.fileName() << "is outdated";
+
+    return valid;
+}
+
+bool DataCache::store(const QString &sourcePath, const Source &source, const Entry &entry)
+{
+    const bool hasAddY = !entry.addY.isEmpty();
+
+    if (!source.isValid() || entry.X.size() != entry.Y.size() || (hasAddY && entry.addY.size() != entry.X.size()))
+        return false;
+
+    Header h = sourceHeader(source);
+
+    h.columns = hasAddY ? 3 : 2;
+    h.count = entry.X.size();
+    h.startPoint = entry.startPoint;
+    h.finishPoint = entry.finishPoint;
+    h.refStartPoint = entry.refStartPoint;
+    h.refFinishPoint = entry.refFinishPoint;
+
+    QSaveFile cache(cachePath(sourcePath));
+
+    if (!cache.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Failed to write cache:" << cache.fileName() << cache.errorString();
+        return false;
+    }
+
+    const qint64 bytes = h.count * qint64(sizeof(double));
+
+    cache.write(reinterpret_cast<const char*>(&h), sizeof(Header));
+    cache.write(reinterpret_cast<const char*>(entry.X.constData()), bytes);
+    cache.write(reinterpret_cast<const char*>(entry.Y.constData()), bytes);
+
+    if (hasAddY)
+        cache.write(reinterpret_cast<const char*>(entry.addY.constData()), bytes);
+
+    if (!cache.commit())
+    {
+        qWarning() << "Failed to write cache:" << cache.fileName() << cache.errorString();
+        return false;
+    }
+
+    return true;
+}
@@ -1,5 +1,6 @@
 #include "dataloader.h"
 #include <cmath>
+#include <atomic>
 #include "dcsettings.h"
 
 DataLoader::DataLoader(QVector<double> &masX, QVector<double> &masY, const QString &name) :
@@ -9,19 +10,82 @@ DataLoader::DataLoader(QVector<double> &masX, QVector<double> &masY, const QStri
     this->X = masX;
     this->Y = masY;
     this->name = name;
+    timeBase.setExplicit(&X);
+    updateIndexes();
 
     if(name.contains("PDOL"))
         maxSize = 2000;
 }
 
+DataLoader::DataLoader(QVector<double> &&masX, QVector<double> &&masY, const QString &name) :
+    X(std::move(masX))
+    , Y(std::move(masY))
+    , name(name)
+    , syncState(false)
+    , maxSize(4000)
+{
+    timeBase.setExplicit(&X);
+    updateIndexes();
+
+    if(name.contains("PDOL"))
+        maxSize = 2000;
+}
+
+DataLoader::DataLoader(const TimeBase &uniformX, QVector<double> &&masY, const QString &name) :
+    Y(std::move(masY))
+    , name(name)
+    , syncState(false)
+    , maxSize(4000)
+{
+    timeBase = uniformX;
+
+    if (!timeBase.isUniform())
+    {
+        X = uniformX.toVector();
+        timeBase.setExplicit(&X);
+    }
+
+    updateIndexes();
+
+    if(name.contains("PDOL"))
+        maxSize = 2000;
+}
+
+void DataLoader::makeExplicit()
+{
+    if (!timeBase.isUniform() && timeBase.shiftOffset() == 0.0) return;
+
+    X = timeBase.toVector();
+    timeBase.setExplicit(&X);
+}
+
+void DataLoader::updateIndexes()
+{
+    pyramid.build(Y);
+    touch();
+}
+
+void DataLoader::touch()
+{
+    static std::atomic<quint64> counter {0};
+
+    rev = ++counter; // unique across loaders, so a revision also identifies the curve
+}
+
+void DataLoader::setUniformX(double start, double step, qsizetype count)
+{
+    X = QVector<double>(); // the grid replaces the stored timestamps
+    timeBase.setUniform(start, step, count);
+}
+
 QString DataLoader::FilePath() const
 {
     return this->path;
 }
 
-const QVector<double> &DataLoader::getX() const
+const TimeBase &DataLoader::getX() const
 {
-    return X;
+    return timeBase;
 }
 
 const QVector<double> &DataLoader::getY() const
@@ -38,26 +102,24 @@ void DataLoader::setPath(const QString &filePath)
 
 double DataLoader::getStartX() const
 {
-    if(X.isEmpty()) return 0;
+    if(timeBase.isEmpty()) return 0;
 
-    return X[0];
+    return timeBase.front();
 }
 
 double DataLoader::getFinishX() const
 {
-    if(X.isEmpty()) return 0;
+    if(timeBase.isEmpty()) return 0;
 
-    return X[X.size() - 1];
+    return timeBase.back();
 }
 
 void DataLoader::shiftX(const double &num)
 {
     shiftAmount += num;
 
-    for (int i = 0; i < X.size(); i++)
-    {
-        X[i] += num;
-    }
+    timeBase.shift(num); // applied on read, O(1)
+    touch();
 
     // shift signal
     // connected to PlotWidget::dataShifted()
@@ -69,7 +131,7 @@ double DataLoader::getShiftAmount()
     return shiftAmount;
 }
 
-void DataLoader::setYData(QVector<double> &yData)
+void DataLoader::setYData(QVector<double> &yData, bool keepsOrder)
 {
     qDebug() << "setYData old:" << Y.back() - Y.front() << "new:" << yData.back() - yData.front();
 
@@ -78,7 +140,14 @@ void DataLoader::setYData(QVector<double> &yData)
         qDebug() << "old:" << Y[k] << "new:" << yData[k];
     }
 
+    const bool sameSize = Y.size() == yData.size();
+
     this->Y = yData; 
+
+    if (!keepsOrder || !sameSize)
+        updateIndexes();
+    else
+        touch();
 }
 
 double DataLoader::yRange()
@@ -93,26 +162,30 @@ double DataLoader::totalLen() const
 
 void DataLoader::crop(const double &start, const double &finish)
 {
-    auto itMin = std::lower_bound(X.begin(), X.end(), start);
-    auto itMax = std::upper_bound(X.begin(), X.end(), finish);
-
-    int startInd = int(itMin - X.begin());
-    int endInd   = int(itMax - X.begin());
+    int startInd = int(timeBase.lowerBound(start));
+    int endInd   = int(timeBase.upperBound(finish));
 
     if (startInd >= endInd) return;
 
-    X = X.mid(startInd, endInd - startInd);
+    if (timeBase.isUniform())
+        timeBase.crop(startInd, endInd - startInd);
+    else
+        X = X.mid(startInd, endInd - startInd);
+
     Y = Y.mid(startInd, endInd - startInd);
+    updateIndexes();
 }
 
 int DataLoader::size() const
 {
-    return X.size();
+    return int(timeBase.size());
 }
 
 void DataLoader::stretchFromMiddle(const double &factor)
 {
-    if(X.size() == 0 || Y.size() == 0 || factor == 1.0) return;
+    if(timeBase.size() == 0 || Y.size() == 0 || factor == 1.0) return;
+
+    makeExplicit();
 
     qDebug() << "X.size():" << X.size();
 
@@ -203,6 +276,7 @@ void DataLoader::stretchFromMiddle(const double &factor)
 
     X = std::move(newX);
     Y = std::move(newY);
+    updateIndexes();
 
     qDebug() << "newX.size():" << X.size();
 
@@ -216,56 +290,41 @@ void DataLoader::saveShift()
 
 void DataLoader::chop(int k)
 {
-    if (X.isEmpty() || k > X.size() || k < 1)
+    if (timeBase.isEmpty() || k > timeBase.size() || k < 1)
         return;
 
-    X.resize(X.size() - k);
+    if (timeBase.isUniform())
+        timeBase.resize(timeBase.size() - k);
+    else
+        X.resize(X.size() - k);
+
     Y.resize(Y.size() - k);
+    pyramid.truncate(Y);
+    touch();
 
     emit xShifted();
 }
 
 void DataLoader::resample(const double &dx)
 {
-    QVector<double> newX, newY;
-    double x, y;
-
-    if(X.size() < 2 || !(X.size() == Y.size()) || dx <= 0) return;
+    if(timeBase.size() < 2 || !(timeBase.size() == Y.size()) || dx <= 0) return;
 
-    double start  = std::ceil(X.front() / dx) * dx;
-    double finish = std::floor(X.back() / dx) * dx;
-    int length = std::floor((finish - start) / dx) + 1;
+    TimeBase grid;
 
-    newX.reserve(length);
-    newY.reserve(length);
-
-    int k = 0, j = 0;
-
-    while(start + k * dx <= finish)
-    {
-        x = start + k * dx;
-
-        while(j < X.size() - 1 && x > X[j + 1])
-            j++;
-
-        if(j + 1 > X.size() - 1) break;
-
-        if(x >= X[j] && x <= X[j + 1] && (X[j + 1] - X[j]) != 0)
-            y = Y[j] + (x - X[j]) / (X[j + 1] - X[j]) * (Y[j + 1] - Y[j]);
-        else
-            break;
-
-        newX.append(x);
-        newY.append(y);
-
-        k++;
-    }
+    if(!ResamplePlan::alignedInPlace(timeBase, dx, 1.0, {&Y}, grid)) return;
 
-    X.swap(newX);
-    Y.swap(newY);
+    // the result lies on the grid start + k * dx, which is kept implicitly
+    setUniformX(grid.gridStart(), grid.gridStep(), grid.size());
+    updateIndexes();
 }
 
-void DataLoader::update(double min, double max, QVector<double> &vis_x, QVector<double> &vis_y) const
+namespace
+{
+
+// visible window of a curve, shared by DataLoader::update and PlotSource::update
+void visibleWindow(const TimeBase &X, const QVector<double> &Y, const MinMaxPyramid &pyramid,
+                   int maxSize, double min, double max,
+                   QVector<double> &vis_x, QVector<double> &vis_y)
 {
     vis_x.clear(); // очистка содержимого
     vis_y.clear();
@@ -274,11 +333,8 @@ void DataLoader::update(double min, double max, QVector<double> &vis_x, QVector<
 
     constexpr double eps = 0.1;
 
-    auto itMin = std::lower_bound(X.begin(), X.end(), min - eps);
-    auto itMax = std::upper_bound(X.begin(), X.end(), max + eps);
-
-    int startInd = int(itMin - X.begin());
-    int endInd = int(itMax - X.begin()) - 1;
+    int startInd = int(X.lowerBound(min - eps));
+    int endInd = int(X.upperBound(max + eps)) - 1;
 
     if (startInd > endInd) return;
 
@@ -307,35 +363,71 @@ void DataLoader::update(double min, double max, QVector<double> &vis_x, QVector<
     }
     else
     {
-        vis_x.reserve(maxSize);
-        vis_y.reserve(maxSize);
+        // M4 decimation: first/min/max/last of each bucket, so no peak is lost
+        QVector<int> indices;
+        indices.reserve(maxSize + 4);
 
-        // шаг для выбора точек
-        double step = (realSize - 1) / double(maxSize - 1);
+        pyramid.decimate(Y, startInd, endInd, maxSize / 4, indices);
 
-        for(int j = 0; j < maxSize; j++)
+        vis_x.reserve(indices.size());
+        vis_y.reserve(indices.size());
+
+        for (int i : std::as_const(indices))
         {
-            int i = int(floor(j * step)) + startInd;
             vis_x.append(X[i]);
             vis_y.append(Y[i]);
         }
     }
 }
 
+}
+
+void DataLoader::update(double min, double max, QVector<double> &vis_x, QVector<double> &vis_y) const
+{
+    visibleWindow(timeBase, Y, pyramid, maxSize, min, max, vis_x, vis_y);
+}
+
+std::shared_ptr<const PlotSource> DataLoader::plotSource() const
+{
+    return std::make_shared<const PlotSource>(X, Y, timeBase, pyramid, maxSize);
+}
+
+PlotSource::PlotSource(const QVector<double> &X, const QVector<double> &Y, const TimeBase &timeBase,
+                       const MinMaxPyramid &pyramid, int maxSize) :
+    X(X)
+    , Y(Y)
+    , timeBase(timeBase)
+    , pyramid(pyramid)
+    , maxSize(maxSize)
+{
+    this->timeBase.rebind(&this->X);
+}
+
+void PlotSource::update(double min, double max, QVector<double> &vis_x, QVector<double> &vis_y) const
+{
+    visibleWindow(timeBase, Y, pyramid, maxSize, min, max, vis_x, vis_y);
+}
+
 double DataLoader::min() const
 {
-    double min = *std::min_element(Y.begin(), Y.end());
-    return min;
+    if (Y.isEmpty()) return 0;
+
+    return Y[pyramid.minIndex(Y, 0, int(Y.size()) - 1)];
 }
 
 double DataLoader::max() const
 {
-    double max = *std::max_element(Y.begin(), Y.end());
-    return max;
+    if (Y.isEmpty()) return 0;
+
+    return Y[pyramid.maxIndex(Y, 0, int(Y.size()) - 1)];
 }
 
-double DataLoader::min(const double &start, const double &finish) const
-{ 
+double DataLoader::extreme(const double &start, const double &finish, bool isMin) const
+{
+    const TimeBase &X = timeBase;
+
+    if (X.isEmpty() || Y.isEmpty()) return 0;
+
     double realStart = qMax(start, X.front());
     double realFinish = qMin(finish, X.back());
 
@@ -345,55 +437,44 @@ double DataLoader::min(const double &start, const double &finish) const
         realFinish = X.back();
     }
 
-    auto st = std::lower_bound(X.begin(), X.end(), realStart);
-    auto fn = std::lower_bound(X.begin(), X.end(), realFinish);
+    int startInd = int(X.lowerBound(realStart));
+    int endInd = int(X.lowerBound(realFinish)); // не включая
 
-    int startInd = int(st - X.begin());
-    int endInd = int(fn - X.begin());
+    int ind = isMin ? pyramid.minIndex(Y, startInd, endInd - 1)
+                    : pyramid.maxIndex(Y, startInd, endInd - 1);
 
-    auto minIt = std::min_element(Y.begin() + startInd,
-                                  Y.begin() + endInd);
+    if (ind < 0) // пустой интервал
+        ind = qMin(startInd, int(Y.size()) - 1);
 
-    return *minIt;
+    return Y[ind];
 }
 
+double DataLoader::min(const double &start, const double &finish) const
+{ 
+    return extreme(start, finish, true);
+}
 
 double DataLoader::max(const double &start, const double &finish) const
 {
-    double realStart = qMax(start, X.front());
-    double realFinish = qMin(finish, X.back());
-
-    auto st = std::lower_bound(X.begin(), X.end(), realStart);
-    auto fn = std::lower_bound(X.begin(), X.end(), realFinish);
-
-    int startInd = int(st - X.begin());
-    int endInd = int(fn - X.begin());
-
-    auto maxIt = std::max_element(Y.begin() + startInd,
-                                  Y.begin() + endInd);
-    return *maxIt;
+    return extreme(start, finish, false);
 }
 
-
 double DataLoader::range() const
 {
-    double maxElem = *std::max_element(Y.begin(), Y.end());
-    double minElem = *std::min_element(Y.begin(), Y.end());
-
-    return maxElem - minElem;
+    return max() - min();
 }
 
 double DataLoader::range(const double &start, const double &finish) const
 {
-    double maxElem = max(start + X.front(), finish + X.front());
-    double minElem = min(start + X.front(), finish + X.front());
+    double maxElem = max(start + timeBase.front(), finish + timeBase.front());
+    double minElem = min(start + timeBase.front(), finish + timeBase.front());
 
     return maxElem - minElem;
 }
 
 void DataLoader::get_start_point(double &start_x, double &start_y) const // геттер начальной точки
 {
-    start_x = X[0];
+    start_x = timeBase[0];
     start_y = Y[0];
 }
 
@@ -410,14 +491,14 @@ void DataLoader::getTime(double &start, double &end) const
 
 void DataLoader::setStart(double &time)
 {
-    for (int i = 0; i < X.size(); i++)
-        X[i] += time;
+    timeBase.shift(time);
+    touch();
 }
 
 void DataLoader::getXRange(double &start, double &end) const
 {
-    start = X[0];
-    end = X[X.size() - 1];
+    start = timeBase.front();
+    end = timeBase.back();
 }
 
 void DataLoader::setTime(double &start, double &end, double &rStart, double &rEnd)
@@ -438,8 +519,8 @@ void DataLoader::setSyncPoints(double start, double finish, double startRef, dou
 
 void DataLoader::setDeltaTime(double const &delta)
 {
-    for(int i = 0; i < X.size(); i++)
-        X[i] += delta;
+    timeBase.shift(delta);
+    touch();
 }
 
 double DataLoader::deltaTime() const
@@ -451,55 +532,48 @@ double DataLoader::deltaTime() const
 // слот для изменения состояния синхронизации времени
 void DataLoader::timeSync(const double &factor)
 {
-    QVector<double> newX, newY;
-    double x, y, dx;
+    timeSync({this}, factor);
+}
 
-    if(X.isEmpty()) return;
+void DataLoader::timeSync(const QVector<DataLoader *> &axes, const double &factor)
+{
+    if(axes.isEmpty() || axes.front()->timeBase.isEmpty()) return;
 
-    dx = 0.008;
+    const TimeBase &X = axes.front()->timeBase;
 
-    for(int i = 0; i < X.size(); i++)
-    {
-        X[i] = X.front() + (X[i] - X.front()) * factor;
-    }
+    QVector<QVector<double> *> channels;
 
-    double start  = std::ceil(X.front() / dx) * dx;
-    double finish = std::floor(X.back() / dx) * dx;
-    double length = std::floor((finish - start) / dx) + 1;
+    for(DataLoader *axis : axes)
+        channels.append(&axis->Y);
 
-    newX.reserve(length);
-    newY.reserve(length);
+    // передискретизация с шагом 8 мс растянутой в factor раз шкалы времени, на месте:
+    // ни растянутая копия X, ни новый массив Y не создаются
+    TimeBase grid;
 
-    int k = 0, j = 0;
+    if(!ResamplePlan::alignedInPlace(X, 0.008, factor, channels, grid)) return;
 
-    // передискретизация с шагом dx
-    while(start + k * dx <= finish)
+    for(DataLoader *axis : axes)
     {
-        x = start + k * dx;
-
-        while(x > X[j + 1] && j < X.size() - 1)
-            j++;
-
-        if(j + 1 > X.size() - 1) break;
-
-        if(x >= X[j] && x <= X[j + 1])
-            y = Y[j] + (x - X[j]) / (X[j + 1] - X[j]) * (Y[j + 1] - Y[j]);
-        else
-            break;
-
-        newX.append(x);
-        newY.append(y);
+        // the result lies on the grid start + k * dx, which is kept implicitly
+        axis->setUniformX(grid.gridStart(), grid.gridStep(), grid.size());
+        axis->updateIndexes();
+        axis->syncState = true;
 
-        k++;
+        qDebug() << "newX.size():" << axis->timeBase.size();
+        qDebug() << "SYNCFACTOR" << axis->name << ":" << factor;
     }
+}
 
-    X.swap(newX);
-    Y.swap(newY);
+bool DataLoader::sharesTime(const DataLoader &other) const
+{
+    const TimeBase &a = timeBase, &b = other.timeBase;
 
-    qDebug() << "newX.size():" << X.size();
-    qDebug() << "SYNCFACTOR" << name << ":" << factor;
+    if(a.size() != b.size()) return false;
 
-    syncState = true;
+    for(qsizetype i = 0; i < a.size(); i++)
+        if(a[i] != b[i]) return false;
+
+    return true;
 }
 
 
@@ -519,18 +593,17 @@ bool DataLoader::getSyncState()
 bool DataLoader::getDataPart(const double &start, const double &finish,
                              QVector<double> &xMas, QVector<double> &yMas) const
 {
+    const TimeBase &X = timeBase;
+
     if(start < X[0] || finish > X[X.size() - 1])
         return false;
 
-    auto startIt  = std::lower_bound(X.begin(), X.end(), start);
-    auto finishIt = std::upper_bound(X.begin(), X.end(), finish);
+    int startIndex  = static_cast<int>(X.lowerBound(start));
+    int finishIndex = static_cast<int>(X.upperBound(finish));
 
-    if (startIt == X.end() || finishIt == X.begin())
+    if (startIndex == X.size() || finishIndex == 0)
         return false;
 
-    int startIndex  = static_cast<int>(std::distance(X.begin(), startIt));
-    int finishIndex = static_cast<int>(std::distance(X.begin(), finishIt));
-
     if (finishIndex <= startIndex)
         return false;
 
@@ -553,8 +626,8 @@ bool DataLoader::getDataPart(const double &start, const double &finish,
 
 bool DataLoader::getDataPart(const double &start, const double &finish, QVector<double> &yMas) const
 {
-    int startIndex = X.indexOf(start);
-    int finishIndex = X.indexOf(finish);
+    int startIndex = int(timeBase.indexOf(start));
+    int finishIndex = int(timeBase.indexOf(finish));
 
     if(startIndex == -1 || finishIndex == -1 || startIndex >= finishIndex)
     {
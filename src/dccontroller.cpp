@@ -7,12 +7,16 @@
 #include "dcsettings.h"
 #include "przmanager.h"
 #include "snapshotmanager.h"
+#include "resampleplan.h"
 #include <QThread>
+#include <numeric>
 
 
 DCController::DCController(QObject *parent)
     : QObject{parent}
-{}
+{
+    connect(&loadScheduler, &LoadScheduler::batchFinished, this, &DCController::onFilesLoaded);
+}
 
 DCController &DCController::instance()
 {
@@ -96,6 +100,8 @@ void DCController::saveLastPath(const QString &path)
 
 DCController::~DCController()
 {
+    loadScheduler.cancel();
+
     for (auto* th : findChildren<QThread*>())
     { th->requestInterruption(); th->quit(); th->wait(); }
 
@@ -103,53 +109,43 @@ DCController::~DCController()
         delete loaders[i];
 }
 
-void DCController::startConverter(const QString &path)
-{
-    QString fname = QFileInfo(path).fileName();
-    int win = 0;
-    if(fname.contains("DN", Qt::CaseInsensitive))
-        win = window->ADNWindow();
-
-    FileConverter* converter = new FileConverter(path, win);
-    QThread* thread = new QThread(this);
-
-    converter->moveToThread(thread);
-    connect(thread,  &QThread::started, converter, &FileConverter::loadFiles);
-
-    connect(converter, &FileConverter::progressUpdated,  this, &DCController::onProgress);
-    connect(converter, &FileConverter::finished,  this, &DCController::onFinished);
-    connect(converter, &FileConverter::errorOccurred, this, &DCController::onError);
-
-    connect(converter, &FileConverter::finished, thread, &QThread::quit);
-    connect(converter, &FileConverter::finished, converter, &QObject::deleteLater);
-    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
-
-    thread->start();
-}
-
 void DCController::onProgress(const QString &fileId, int percent)
 {
     window->updateProgress(fileId, percent);
 }
 
-void DCController::onFinished(QString fileId, QVector<double> X,
-                              QVector<double> Y, double syncFactor, double delta)
+void DCController::onFinished(QSharedPointer<LoadedFile> file)
 {
-    DataLoader *loader = new DataLoader(X,Y,fileId);
+    const QString fileId = file->fileId;
 
-    loaders.append(loader);
-    syncFactors.append(syncFactor);
+    if (file->dualAxis)
+    {
+        // both DV axes share one timebase; it is only copied if one of them is shifted
+        loaders.append(new DataLoader(QVector<double>(file->X), std::move(file->Y), fileId + "_Z"));
+        loaders.append(new DataLoader(std::move(file->X), std::move(file->addY), fileId + "_X"));
+
+        syncFactors.append(file->syncFactor);
+        syncFactors.append(file->syncFactor);
+    }
+
+    else
+    {
+        loaders.append(new DataLoader(std::move(file->X), std::move(file->Y), fileId));
+        syncFactors.append(file->syncFactor);
+    }
 
     if(deltaRealTime == 0 && (fileId.contains("DN", Qt::CaseInsensitive)
                        || fileId.contains("MK") || fileId.contains("KM") || fileId.contains("DV")))
     {
-        deltaRealTime = delta;
-        qDebug() << "delta:" << delta;
+        deltaRealTime = file->delta;
+        qDebug() << "delta:" << file->delta;
     }
+}
 
-    filesLoaded += 1;
-
-    if(filesLoaded < filesToLoad) return;
+// called once when every file of the load has been converted (or failed)
+void DCController::onFilesLoaded(bool cancelled)
+{
+    if (cancelled) return;
 
     if(DCSettings::instance().getTimeSync())
     {
@@ -242,7 +238,7 @@ void DCController::onFinished(QString fileId, QVector<double> X,
 
 void DCController::onError(QString fileId, QString msg)
 {
-    filesToLoad -= 1;
+    qWarning() << fileId << msg;
 }
 
 
@@ -257,31 +253,13 @@ bool DCController::resampleGl1(const QVector<double> &X,
 
     if(X.size() < 2 || Y.size() < 2) return false;
 
-    double t = X[0];
-    int frame = 0;
+    // кадры через newStep от первой точки
+    const ResamplePlan plan = ResamplePlan::fromFirst(TimeBase(&X), newStep);
 
-    int i = 0;
+    if(!plan.apply(Y, resY)) return false;
 
-    while (t <= X.back())
-    {
-        while(i + 1 < X.size() && X[i + 1] < t)
-            i++;
-
-        if (i + 1 >= X.size())
-            break;
-
-        // точки, между которыми лежит искомая (со временем t)
-        double x0 = X[i], x1 = X[i + 1];
-        double y0 = Y[i], y1 = Y[i + 1];
-
-        double y = y0 + (y1 - y0) * (t - x0) / (x1 - x0);
-
-        resX.append(frame);
-        resY.append(y);
-        frame++;
-
-        t += newStep;
-    }
+    resX.resize(plan.size());
+    std::iota(resX.begin(), resX.end(), 0);
 
     return true;
 }
@@ -296,18 +274,34 @@ bool DCController::syncFactorIsOK(const double &factor)
 
 void DCController::loadFiles(const QVector<QString> &paths, bool sync)
 {
-    filesToLoad = paths.size();
-    filesLoaded = 0;
     deltaRealTime = 0;
     syncFactors.clear();
 
+    QVector<LoadScheduler::Job> jobs;
+
     for(int i = 0; i < paths.size(); i++)
     {
-        QString name = QFileInfo(paths[i]).fileName();
-        if(name.contains("DV", Qt::CaseInsensitive))
-            filesToLoad += 1;
-        startConverter(paths[i]);
+        QString fname = QFileInfo(paths[i]).fileName();
+        int win = 0;
+        if(fname.contains("DN", Qt::CaseInsensitive))
+            win = window->ADNWindow();
+
+        jobs.append({paths[i], win});
     }
+
+    const quint64 generation = ++loadGeneration;
+
+    // converters live on the pool threads; their results are queued to this thread
+    loadScheduler.start(jobs, [this, generation](FileConverter *converter) {
+        connect(converter, &FileConverter::progressUpdated, this, &DCController::onProgress);
+        connect(converter, &FileConverter::errorOccurred, this, &DCController::onError);
+
+        connect(converter, &FileConverter::finished, this,
+                [this, generation](QSharedPointer<LoadedFile> file) {
+            if (generation == loadGeneration)
+                onFinished(file);
+        });
+    });
 }
 
 // слот для авто определения пор. нагрузки
@@ -326,7 +320,7 @@ void DCController::manualADNLoad(const double &lvl)
     DataLoader* adn = nullptr;
     DataLoader* prz = nullptr;
     QVector<double> lenghts;
-    QVector<QCPItemRect *> intervals;
+    IntervalModel intervals;
 
     for(int i = 0; i < loaders.size(); i++)
     {
@@ -343,7 +337,7 @@ void DCController::manualADNLoad(const double &lvl)
     mainPlot->setLoadLine(lvl);
     mainPlot->getPDIntervals(intervals);
 
-    Gl1Manager::instance().getLenghts(lenghts, &prz->getX(), &prz->getY(), intervals);
+    Gl1Manager::instance().getLenghts(lenghts, prz, intervals);
 
     for(int i = 0; i < intervals.size() && i < lenghts.size(); i++)
     {
@@ -365,7 +359,7 @@ void DCController::przToPDDone(QVector<double> X, QVector<double> Y, QVector<dou
     emit loaderAdded(loader);
     Gl1Manager::instance().setLoaders(loaders);
 
-    QVector<QCPItemRect*> intervals;
+    IntervalModel intervals;
     mainPlot->getPDIntervals(intervals);
     intervalsChanged(intervals);
 }
@@ -376,7 +370,7 @@ void DCController::PDcreate(double time,
                             const double &secondPoint)
 {
     DataLoader *prz = nullptr;
-    QVector<QCPItemRect*> intervals;
+    IntervalModel intervals;
 
     mainPlot->getPDIntervals(intervals);
 
@@ -417,7 +411,7 @@ void DCController::gl1Create(double time,
                              const QString &method)
 {
     DataLoader *prz = nullptr;
-    QVector<QCPItemRect*> intervals;
+    IntervalModel intervals;
 
     for(int i = 0; i < loaders.size(); i++)
     {
@@ -468,7 +462,7 @@ void DCController::pdToGl1Done(QVector<double> X, QVector<double> Y)
     emit loaderAdded(loader);
     Gl1Manager::instance().setLoaders(loaders);
 
-    QVector<QCPItemRect*> intervals;
+    IntervalModel intervals;
     mainPlot->getPDIntervals(intervals);
     intervalsChanged(intervals);
 
@@ -533,7 +527,7 @@ void DCController::przConvert()
     QVector<double> Y, przX, przY;
     double max = prz->max();
 
-    przX = prz->getX();
+    przX = prz->getX().toVector();
     przY = prz->getY();
 
     if(przX.isEmpty() || przY.isEmpty()) return;
@@ -579,7 +573,7 @@ void DCController::savePDOLFile(const QString &path, const QString &format)
     {
         if(loaders[i]->getName().contains("PDOL"))
         {
-            X = loaders[i]->getX();
+            X = loaders[i]->getX().toVector();
             Y = loaders[i]->getY();
         }
     }
@@ -591,9 +585,9 @@ void DCController::savePDOLFile(const QString &path, const QString &format)
 }
 
 // метод для инициализации строк таблиц интервалов (не используется)
-void DCController::initTables(QVector<QCPItemRect *> *rectangles)
+void DCController::initTables(const IntervalModel &intervals)
 {
-    for(int i = 0; i < rectangles->size(); i++)
+    for(int i = 0; i < intervals.size(); i++)
     {
         window->addIntervalRow("PDOL", i + 1);
         window->addIntervalRow("gl1", i + 1);
@@ -681,53 +675,39 @@ void DCController::addInterval(const QString &first, const QString &second)
     }
 }
 
-void DCController::intervalsChanged(const QVector<QCPItemRect *> &intervals)
+void DCController::intervalsChanged(const IntervalModel &intervals)
 {
-    QVector<double> pdLenghts, pdDepth, pdSpeed, gl1Lenghts, gl1Depth, gl1Speed;
-    const QVector<double> *pdX = nullptr, *pdY = nullptr, *gl1X = nullptr, *gl1Y = nullptr;
+    QVector<const DataLoader*> curves;
+    QVector<QString> tables;
 
     for(int i = 0; i < loaders.size(); i++)
     {
         if(loaders[i]->getName().contains("PDOL", Qt::CaseInsensitive))
         {
-            pdX = &loaders[i]->getX();
-            pdY = &loaders[i]->getY();
+            curves.append(loaders[i]);
+            tables.append("PDOL");
             window->clearTable("PDOL");
         }
 
         if(loaders[i]->getName().contains("gl1", Qt::CaseInsensitive))
         {
-            gl1X = &loaders[i]->getX();
-            gl1Y = &loaders[i]->getY();
+            curves.append(loaders[i]);
+            tables.append("gl1");
             window->clearTable("gl1");
         }
     }
 
-    if(pdX && pdY && !pdX->isEmpty() && !pdY->isEmpty())
-    {
-        Gl1Manager::instance().getParams(pdLenghts,
-                                         pdDepth,
-                                         pdSpeed,
-                                         pdX, pdY,
-                                         intervals);
+    if(curves.isEmpty()) return;
 
-        for (int i = 0; i < intervals.size(); i++)
-        {
-            window->addIntervalRow("PDOL", i + 1, pdLenghts[i], -1, -1, pdDepth[i], pdSpeed[i]);
-        }
-    }
+    // all curves in one call; intervals untouched since the last call are taken from the cache
+    const QVector<QVector<IntervalStats::Row>> params = Gl1Manager::instance().getParams(curves, intervals);
 
-    if(gl1X && gl1Y && !gl1X->isEmpty() && !gl1Y->isEmpty())
+    for(int c = 0; c < curves.size(); c++)
     {
-        Gl1Manager::instance().getParams(gl1Lenghts,
-                                         gl1Depth,
-                                         gl1Speed,
-                                         gl1X, gl1Y,
-                                         intervals);
-
-        for (int i = 0; i < intervals.size() && i < gl1Lenghts.size() && i < gl1Depth.size() && i < gl1Speed.size(); i++)
+        for(int i = 0; i < params[c].size(); i++)
         {
-            window->addIntervalRow("gl1", i + 1, gl1Lenghts[i], -1, -1, gl1Depth[i], gl1Speed[i]);
+            const IntervalStats::Row &row = params[c][i];
+            window->addIntervalRow(tables[c], i + 1, row.length, -1, -1, row.depth, row.speed);
         }
     }
 }
@@ -854,7 +834,7 @@ void DCController::gl1Correction(const bool &candle, const bool &len, double tot
         const double &refTime, const double &refDepth)
 {
     DataLoader *loader = nullptr;
-    QVector<QCPItemRect*> intervals;
+    IntervalModel intervals;
     int refTotalLen;
 
     mainPlot->getPDIntervals(intervals);
@@ -910,7 +890,7 @@ void DCController::pdCorrection(const bool &candle, const bool &len, double tota
         const double &refTime, const double &refDepth)
 {
     DataLoader *loader = nullptr;
-    QVector<QCPItemRect*> intervals;
+    IntervalModel intervals;
     int refTotalLen;
 
     mainPlot->getPDIntervals(intervals);
@@ -968,7 +948,7 @@ void DCController::saveGl1File(const QString &path, int startFrame)
     {
         if(loaders[i]->getName().contains("gl1", Qt::CaseInsensitive))
         {
-            X = loaders[i]->getX();
+            X = loaders[i]->getX().toVector();
             Y = loaders[i]->getY();
             break;
         }
@@ -988,6 +968,10 @@ void DCController::saveGl1File(const QString &path, int startFrame)
 
 void DCController::cleanAll()
 {
+    // a load still in progress is dropped together with the plot
+    loadScheduler.cancel();
+    loadGeneration++;
+
     if (loaders.isEmpty()) return;
 
     QVector<DataLoader*> loadersToDelete = loaders;
@@ -1000,8 +984,6 @@ void DCController::cleanAll()
     }
 
     syncFactors.clear();
-    filesToLoad = 0;
-    filesLoaded = 0;
 
     window->clear();
 }
@@ -1158,9 +1140,10 @@ void DCController::applySnapshotToLoaders
     for(int i = 0; i < loadersInfo.size(); i++)
     {
         const auto &info = loadersInfo[i];
-        QVector<double> X = info.X;
         QVector<double> Y = info.Y;
-        DataLoader *loader = new DataLoader(X, Y, info.name);
+        DataLoader *loader = info.grid.isUniform()
+            ? new DataLoader(info.grid, std::move(Y), info.name)
+            : new DataLoader(QVector<double>(info.X), std::move(Y), info.name);
         loader->setParent(this);
         loaders.append(loader);
     }
@@ -16,6 +16,9 @@ DCSettings &DCSettings::instance()
 void DCSettings::load()
 {
     timeSync = settings.value("timeSync", timeSyncDef()).toBool();
+    useCache = settings.value("useCache", useCacheDef()).toBool();
+    loadWorkers = settings.value("loadWorkers", loadWorkersDef()).toInt();
+    useOpenGl = settings.value("useOpenGl", useOpenGlDef()).toBool();
     dnMed = settings.value("dnMed", dnMedDef()).toInt();
     dvMed = settings.value("dvMed", dvMedDef()).toInt();
     dvExp = settings.value("dvExp",dvExpDef()).toDouble();
@@ -48,6 +51,26 @@ void DCSettings::applyChanges(const SettingsDelta &d)
         settings.setValue("timeSync", timeSync);
     }
 
+    if(d.useCache && *d.useCache != useCache)
+    {
+        useCache = *d.useCache;
+        settings.setValue("useCache", useCache);
+    }
+
+    if(d.loadWorkers && *d.loadWorkers != loadWorkers)
+    {
+        loadWorkers = *d.loadWorkers;
+        settings.setValue("loadWorkers", loadWorkers);
+    }
+
+    if(d.useOpenGl && *d.useOpenGl != useOpenGl)
+    {
+        useOpenGl = *d.useOpenGl;
+        settings.setValue("useOpenGl", useOpenGl);
+
+        emit renderBackendChanged();
+    }
+
     if(d.dvMed && *d.dvMed != dvMed)
     {
         dvMed = *d.dvMed;
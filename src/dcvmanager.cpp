@@ -56,7 +56,7 @@ void DCVManager::addSnap(const QVector<DataLoader *> &loaders)
         QString name = fileinfo.completeBaseName();
         QString fname = loaders[i]->getName();
 
-        QVector<double> X = loaders[i]->getX();
+        QVector<double> X = loaders[i]->getX().toVector();
         QVector<double> Y = loaders[i]->getY();
 
         QString tempFilePath = "";
@@ -25,7 +25,8 @@ bool Gl1Manager::detLoad()
 {
     if (loaders.isEmpty()) return false;
 
-    const QVector<double> *przX = nullptr, *adnX = nullptr, *przY = nullptr, *adnY = nullptr;
+    const TimeBase *przX = nullptr, *adnX = nullptr;
+    const QVector<double> *przY = nullptr, *adnY = nullptr;
     int countUp = 0, countDown = 0;
     int przIndex = -1, adnIndex = -1, a, p;
     double up = 0, down = 0;
@@ -116,9 +117,9 @@ void Gl1Manager::setWindowWidth(const int &num)
 
 
 // method for trimming idle runs
-void Gl1Manager::przToPD(const QVector<double> *X,
+void Gl1Manager::przToPD(const TimeBase *X,
                          const QVector<double> *Y,
-                         QVector<QCPItemRect*> &intervals,
+                         IntervalModel &intervals,
                          double time,
                          double depth,
                          const double &firstPoint,
@@ -142,9 +143,9 @@ void Gl1Manager::przToPD(const QVector<double> *X,
     }
 }
 
-void Gl1Manager::przToGl1(const QVector<double> *X,
+void Gl1Manager::przToGl1(const TimeBase *X,
                           const QVector<double> *Y,
-                          QVector<QCPItemRect*> &intervals,
+                          IntervalModel &intervals,
                           double time,
                           double depth,
                           const double &firstPoint,
@@ -191,118 +192,81 @@ void Gl1Manager::pdToGl1(const QVector<double> *X, const QVector<double> *Y, con
 }
 
 void Gl1Manager::getLenghts(QVector<double> &lenghts,
-                            const QVector<double> *X,
-                            const QVector<double> *Y,
-                            const QVector<QCPItemRect *> &intervals)
+                            const DataLoader *curve,
+                            const IntervalModel &intervals)
 {
     lenghts.clear();
     this->length.clear();
 
     this->moveIntervals = intervals;
 
-    for(int i = 0; i < intervals.size(); i++)
-    {
-        int k = 1;
-        double st = intervals[i]->topLeft->key();      // left X coordinate
-        double fn = intervals[i]->bottomRight->key();  // right X coordinate
-
-        while(k < X->size())
-        {
-            if((*X)[k] < st)
-            {
-                k++;
-                continue;
-            }
+    const TimeBase &X = curve->getX();
+    const QVector<double> &Y = curve->getY();
+    const qsizetype n = qMin(X.size(), Y.size());
 
-            else if((*X)[k] >= st)
-            {
-                double depth1 = (*Y)[k];
+    // sample indices of all intervals in one sweep (cached for this state of the curve)
+    const QVector<IntervalModel::SampleRange> ranges = intervals.sampleRanges(X, curve->revision());
 
-                while(k < (*X).size() && k < Y->size() && (*X)[k] <= fn)
-                {
-                    k++;
-                }
+    for(int i = 0; i < ranges.size(); i++)
+    {
+        // from the first sample at or after the start (skipping sample 0)
+        // to the first one after the finish
+        const qsizetype first = qMax<qsizetype>(1, ranges[i].first);
+        if(first >= n) break;
 
-                lenghts.append(abs((*Y)[k] - depth1) * 100);
-                length.append(abs((*Y)[k] - depth1) * 100);
+        const qsizetype last = qMin(qMax(ranges[i].end, first), n - 1);
+        const double len = abs(Y[last] - Y[first]) * 100;
 
-                break;
-            }
-        }
+        lenghts.append(len);
+        length.append(len);
     }
 }
 
 void Gl1Manager::getParams(QVector<double> &lenghts,
                            QVector<double> &depth,
                            QVector<double> &speed,
-                           const QVector<double> *X,
-                           const QVector<double> *Y,
-                           const QVector<QCPItemRect *> &intervals)
+                           const DataLoader *curve,
+                           const IntervalModel &intervals)
 {
     lenghts.clear(); depth.clear(); speed.clear();
     this->length.clear(); this->errors.clear();
     this->depth.clear();  this->speed.clear();
     this->moveIntervals = intervals;
 
-    if (!X || !Y || X->isEmpty() || Y->isEmpty()) return;
-
-    for (int i = 0; i < intervals.size(); ++i) {
-        const double st = intervals[i]->topLeft->key();
-        const double fn = intervals[i]->bottomRight->key();
-        if (st > fn) continue;
-
-        // indices covering the interval [st, fn] on the X axis
-        auto itL = std::lower_bound(X->begin(), X->end(), st);
-        auto itR = std::upper_bound(X->begin(), X->end(), fn);
-
-        // if there are no points in the interval
-        if (itL == X->end() || itL == itR)
-        {
-
-            depth.append(0);
-            this->depth.append(0);
+    const QVector<IntervalStats::Row> rows = intervalStats.rows(curve, intervals);
 
-            lenghts.append(0);
-            this->length.append(0);
-
-            speed.append(0);
-            this->speed.append(0);
-
-            continue;
-        }
-
-        const int startIdx = int(itL - X->begin());
-        const int endIdx   = int(itR - X->begin()) - 1;
-        if (endIdx < startIdx) continue;
-
-        const double depth1 = (*Y)[startIdx];
-        const double depth2 = (*Y)[endIdx];
-
-        const double dDepth_cm = std::abs(depth2 - depth1) * 100.0;
-        const double v = (fn > st) ? (std::abs(depth2 - depth1) / (fn - st) * 3600.0) : 0.0;
+    for (const IntervalStats::Row &row : rows)
+    {
+        lenghts.append(row.length);
+        depth.append(row.depth);
+        speed.append(row.speed);
+    }
 
-        depth.append(depth2);
-        this->depth.append(depth2);
+    this->length = lenghts;
+    this->depth = depth;
+    this->speed = speed;
+}
 
-        lenghts.append(dDepth_cm);
-        this->length.append(dDepth_cm);
+QVector<QVector<IntervalStats::Row>> Gl1Manager::getParams(const QVector<const DataLoader*> &curves,
+                                                           const IntervalModel &intervals)
+{
+    this->moveIntervals = intervals;
 
-        speed.append(v);
-        this->speed.append(v);
-    }
+    return intervalStats.rows(curves, intervals);
 }
 
 void Gl1Manager::candleCorrection(DataLoader *loader,
                                   QVector<double> &lenghts,
                                   QVector<double> &measLengths,
-                                  const QVector<QCPItemRect*> &intervals,
+                                  const IntervalModel &intervals,
                                   const double &window)
 {
     if(!loader->getName().contains("gl1", Qt::CaseInsensitive)
        && !loader->getName().contains("PDOL", Qt::CaseInsensitive)) return;
     if(window < 0) return;
 
-    const QVector<double> X = loader->getX(), Y = loader->getY();
+    const TimeBase &X = loader->getX();
+    const QVector<double> Y = loader->getY();
     QVector<double> coefficients, resCoef, resY = Y;
 
     if(X.isEmpty() || Y.isEmpty()) return;
@@ -352,7 +316,7 @@ void Gl1Manager::candleCorrection(DataLoader *loader,
 
     for(int i = 0; i < intervals.size() && i < resCoef.size(); i++)
     {        
-        double fn = intervals[i]->bottomRight->key();
+        double fn = intervals[i].finish;
         double refY = Y[k] + delta;
         double corCoef = resCoef[i];
 
@@ -381,7 +345,7 @@ void Gl1Manager::lengthCorrection(DataLoader *loader, double refTotalLen)
     QVector<double> resY;
     double totalLen, corCoef;
 
-    const QVector<double> X = loader->getX();
+    const TimeBase &X = loader->getX();
     const QVector<double> Y = loader->getY();
 
 
@@ -412,7 +376,7 @@ void Gl1Manager::lengthCorrection(DataLoader *loader, double refTotalLen)
         qDebug() << "new in lenCor:" << QString::number(resY[k], 'f', 9);
     }
 
-    loader->setYData(resY);
+    loader->setYData(resY, corCoef > 0); // affine around the start point
 
     qDebug() << "LOADER" << loader->getName() << "LEN CORRECTED";
     qDebug() << "LEN COR COEFFICIENT:" << corCoef;
@@ -424,9 +388,9 @@ void Gl1Manager::lengthCorrection(DataLoader *loader, double refTotalLen)
 bool Gl1Manager::localPrzToPD(QVector<double> &resX,
                               QVector<double> &resY,
                               QVector<double> &lenghts,
-                              const QVector<double> *X,
+                              const TimeBase *X,
                               const QVector<double> *Y,
-                              QVector<QCPItemRect *> &intervals,
+                              IntervalModel &intervals,
                               double time,
                               double depth,
                               const double &firstPoint,
@@ -437,8 +401,8 @@ bool Gl1Manager::localPrzToPD(QVector<double> &resX,
 
     this->moveIntervals = intervals;
 
-    double len = 0.0, refDepth = 0.0, start = 0, finish = 0, st, fn;
-    double max = intervals.back()->bottomRight->key();
+    double len = 0.0, refDepth = 0.0, start = 0, finish = 0;
+    double max = intervals.back().finish;
 
     // set start and end points (may be swapped)
     start = firstPoint < secondPoint ? firstPoint : secondPoint;
@@ -448,24 +412,12 @@ bool Gl1Manager::localPrzToPD(QVector<double> &resX,
         finish = max;
     else
     {
-        // trim the extra right part
-        for(int i = 0; i < intervals.size(); i++)
-        {
-            st = intervals[i]->topLeft->key();
-            fn = intervals[i]->bottomRight->key();
-
-            if(fn < secondPoint) continue;
+        // trim the extra right part: if secondPoint falls into a gap,
+        // finish at the end of the interval before it
+        const qsizetype i = intervals.firstEndingFrom(secondPoint);
 
-            else if(st > secondPoint)
-            {
-                if(secondPoint < intervals[i - 1]->bottomRight->key())
-                    break;
-                finish = intervals[i - 1]->bottomRight->key() - 1;
-                break;
-            }
-
-            else break;
-        }
+        if(i > 0 && i < intervals.size() && intervals[i].start > secondPoint)
+            finish = intervals[i - 1].finish - 1;
     }
 
     if(time  < (*X)[0] || time > (*X).back())
@@ -498,8 +450,8 @@ bool Gl1Manager::localPrzToPD(QVector<double> &resX,
     // iterate all intervals
     for(int i = 0; i < intervals.size(); i++)
     {
-        double st = intervals[i]->topLeft->key();      // left X coordinate
-        double fn = intervals[i]->bottomRight->key();  // right X coordinate
+        double st = intervals[i].start;   // left X coordinate
+        double fn = intervals[i].finish;  // right X coordinate
 
         while(k < X->size() - 1)
         {
@@ -685,7 +637,7 @@ void Gl1Manager::leavingCorrection(DataLoader *loader,
         && !loader->getName().contains("PDOL", Qt::CaseInsensitive)) 
         return;
 
-    const QVector<double> X = loader->getX();
+    const TimeBase &X = loader->getX();
     const QVector<double> Y = loader->getY();
 
     if (X.isEmpty() || Y.isEmpty()) 
@@ -713,7 +665,7 @@ void Gl1Manager::leavingCorrection(DataLoader *loader,
     for (int i = 0; i < resY.size(); i++)
         resY[i] += delta;
 
-    loader->setYData(resY);
+    loader->setYData(resY, true); // constant shift
 
     emit lengthCorrectionDone(loader);
 }
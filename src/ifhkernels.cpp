@@ -0,0 +1,150 @@
+#include "ifhkernels.h"
+#include "cpufeatures.h"
+
+namespace
+{
+
+using Kernel = void (*)(const uchar *frames, qsizetype count, double *z, double *x);
+
+using Backend = CpuFeatures::Backend<Kernel>;
+
+// signed 24-bit big-endian value starting at b[0]
+inline qint32 readInt24(const uchar *b)
+{
+    qint32 num = (qint32(b[0]) << 16) | (qint32(b[1]) << 8) | qint32(b[2]);
+    if (b[0] & 0x80) num |= 0xFF000000;
+    return num;
+}
+
+void extractScalar(const uchar *frames, qsizetype count, double *z, double *x)
+{
+    for (qsizetype i = 0; i < count; i++)
+    {
+        const uchar *b = frames + i * IfhKernels::frameSize;
+
+        z[i] = double(readInt24(b + 13));
+
+        if (x)
+            x[i] = double(readInt24(b + 7));
+    }
+}
+
+#ifdef CPU_FEATURES_X86
+
+/*
+ * Both SIMD paths shuffle every frame so that dword 0 holds the Z axis and
+ * dword 1 the X axis as (b0 << 24 | b1 << 16 | b2 << 8); an arithmetic shift
+ * right by 8 then gives the sign-extended 24-bit value.
+ */
+
+CPU_TARGET("ssse3")
+void extractSsse3(const uchar *frames, qsizetype count, double *z, double *x)
+{
+    const __m128i mask = _mm_setr_epi8(-1, 15, 14, 13, -1, 9, 8, 7,
+                                       -1, -1, -1, -1, -1, -1, -1, -1);
+    qsizetype i = 0;
+
+    for (; i + 4 <= count; i += 4)
+    {
+        const uchar *b = frames + i * IfhKernels::frameSize;
+
+        __m128i f0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b)), mask);
+        __m128i f1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 16)), mask);
+        __m128i f2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 32)), mask);
+        __m128i f3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 48)), mask);
+
+        __m128i f01 = _mm_unpacklo_epi32(f0, f1); // z0 z1 x0 x1
+        __m128i f23 = _mm_unpacklo_epi32(f2, f3); // z2 z3 x2 x3
+
+        __m128i zv = _mm_srai_epi32(_mm_unpacklo_epi64(f01, f23), 8);
+
+        _mm_storeu_pd(z + i, _mm_cvtepi32_pd(zv));
+        _mm_storeu_pd(z + i + 2, _mm_cvtepi32_pd(_mm_srli_si128(zv, 8)));
+
+        if (x)
+        {
+            __m128i xv = _mm_srai_epi32(_mm_unpackhi_epi64(f01, f23), 8);
+
+            _mm_storeu_pd(x + i, _mm_cvtepi32_pd(xv));
+            _mm_storeu_pd(x + i + 2, _mm_cvtepi32_pd(_mm_srli_si128(xv, 8)));
+        }
+    }
+
+    extractScalar(frames + i * IfhKernels::frameSize, count - i, z + i, x ? x + i : nullptr);
+}
+
+CPU_TARGET("avx2")
+void extractAvx2(const uchar *frames, qsizetype count, double *z, double *x)
+{
+    const __m256i mask = _mm256_setr_epi8(-1, 15, 14, 13, -1, 9, 8, 7,
+                                          -1, -1, -1, -1, -1, -1, -1, -1,
+                                          -1, 15, 14, 13, -1, 9, 8, 7,
+                                          -1, -1, -1, -1, -1, -1, -1, -1);
+
+    // restores frame order after the in-lane unpacks
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    qsizetype i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        const uchar *b = frames + i * IfhKernels::frameSize;
+
+        // one frame per 128-bit lane
+        __m256i f01 = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b)), mask);
+        __m256i f23 = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 32)), mask);
+        __m256i f45 = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 64)), mask);
+        __m256i f67 = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 96)), mask);
+
+        __m256i lo = _mm256_unpacklo_epi32(f01, f23); // z0 z2 x0 x2 | z1 z3 x1 x3
+        __m256i hi = _mm256_unpacklo_epi32(f45, f67); // z4 z6 x4 x6 | z5 z7 x5 x7
+
+        __m256i zv = _mm256_unpacklo_epi64(lo, hi);   // z0 z2 z4 z6 | z1 z3 z5 z7
+        zv = _mm256_srai_epi32(_mm256_permutevar8x32_epi32(zv, order), 8);
+
+        _mm256_storeu_pd(z + i, _mm256_cvtepi32_pd(_mm256_castsi256_si128(zv)));
+        _mm256_storeu_pd(z + i + 4, _mm256_cvtepi32_pd(_mm256_extracti128_si256(zv, 1)));
+
+        if (x)
+        {
+            __m256i xv = _mm256_unpackhi_epi64(lo, hi);
+            xv = _mm256_srai_epi32(_mm256_permutevar8x32_epi32(xv, order), 8);
+
+            _mm256_storeu_pd(x + i, _mm256_cvtepi32_pd(_mm256_castsi256_si128(xv)));
+            _mm256_storeu_pd(x + i + 4, _mm256_cvtepi32_pd(_mm256_extracti128_si256(xv, 1)));
+        }
+    }
+
+    extractScalar(frames + i * IfhKernels::frameSize, count - i, z + i, x ? x + i : nullptr);
+}
+
+#endif // CPU_FEATURES_X86
+
+Backend selectBackend()
+{
+#ifdef CPU_FEATURES_X86
+    if (CpuFeatures::hasAvx2())
+        return {extractAvx2, "AVX2"};
+
+    if (CpuFeatures::hasSsse3())
+        return {extractSsse3, "SSSE3"};
+#endif
+
+    return {extractScalar, "scalar"};
+}
+
+// chosen on the first decode and logged once per process
+const Backend &backend()
+{
+    static const Backend selected = CpuFeatures::selected("IFH axis", selectBackend());
+    return selected;
+}
+
+} // namespace
+
+void IfhKernels::extractAxes(const uchar *frames, qsizetype count, double *z, double *x)
+{
+    if (count <= 0) return;
+
+    backend().kernel(frames, count, z, x);
+}
@@ -0,0 +1,198 @@
+#include "intervalmodel.h"
+#include <algorithm>
+
+void IntervalModel::clear()
+{
+    replace(0, items.size(), {});
+}
+
+void IntervalModel::append(double start, double finish)
+{
+    replace(items.size(), 0, {{start, finish, nextId++}});
+}
+
+qsizetype IntervalModel::firstEndingFrom(double x) const
+{
+    return std::lower_bound(items.begin(), items.end(), x,
+                            [](const Interval &a, double v) {return a.finish < v;}) - items.begin();
+}
+
+qsizetype IntervalModel::indexAt(double x) const
+{
+    const qsizetype i = firstEndingFrom(x);
+
+    return i < items.size() && items[i].start <= x ? i : -1;
+}
+
+bool IntervalModel::unite(double start, double finish)
+{
+    if (start > finish) std::swap(start, finish);
+
+    // intervals [first, last) touch [start, finish]
+    const qsizetype first = firstEndingFrom(start);
+    const qsizetype last = std::upper_bound(items.begin() + first, items.end(), finish,
+                                            [](double v, const Interval &a) {return v < a.start;}) - items.begin();
+
+    Interval merged {start, finish, 0};
+
+    if (first < last)
+    {
+        if (items[first].start <= start && finish <= items[first].finish) return false;
+
+        merged.start = qMin(start, items[first].start);
+        merged.finish = qMax(finish, items[last - 1].finish);
+        merged.id = items[first].id;
+    }
+    else
+        merged.id = nextId++;
+
+    replace(first, last - first, {merged});
+    return true;
+}
+
+bool IntervalModel::subtract(double start, double finish)
+{
+    if (start > finish) std::swap(start, finish);
+
+    const qsizetype first = firstEndingFrom(start);
+    const qsizetype last = std::upper_bound(items.begin() + first, items.end(), finish,
+                                            [](double v, const Interval &a) {return v < a.start;}) - items.begin();
+
+    if (first == last) return false;
+
+    QVector<Interval> rest;
+
+    for (qsizetype i = first; i < last; i++)
+    {
+        Interval it = items[i];
+
+        if (start <= it.start && finish >= it.finish) continue; // covered: dropped
+
+        if (finish < it.finish && start - cutTolerance < it.start)
+            it.start = finish;                                  // cut at the beginning
+        else if (finish < it.finish)
+        {
+            rest.append({it.start, start, it.id});              // cut in the middle
+            it = {finish, it.finish, nextId++};
+        }
+        else
+            it.finish = start;                                  // cut at the end
+
+        rest.append(it);
+    }
+
+    replace(first, last - first, rest);
+    return true;
+}
+
+bool IntervalModel::crop(double start, double finish)
+{
+    bool changed = false;
+
+    if (!items.isEmpty() && items.front().start < start)
+        changed |= subtract(items.front().start, start);
+
+    if (!items.isEmpty() && items.back().finish > finish)
+        changed |= subtract(finish, items.back().finish);
+
+    return changed;
+}
+
+IntervalModel IntervalModel::mid(qsizetype pos, qsizetype n) const
+{
+    IntervalModel part;
+
+    part.items = items.mid(pos, n);
+    part.nextId = nextId;
+
+    for (const CurveIndex &curve : std::as_const(*index))
+        part.index->append({curve.stamp, curve.ranges.mid(pos, n)});
+
+    return part;
+}
+
+void IntervalModel::replace(qsizetype pos, qsizetype n, const QVector<Interval> &with)
+{
+    items.remove(pos, n);
+
+    for (qsizetype k = 0; k < with.size(); k++)
+        items.insert(pos + k, with[k]);
+
+    // copies taken before the edit keep the indices of their intervals
+    if (index.use_count() > 1)
+        index = std::make_shared<QVector<CurveIndex>>(*index);
+
+    for (CurveIndex &curve : *index)
+    {
+        curve.ranges.remove(pos, n);
+        curve.ranges.insert(pos, with.size(), SampleRange{-1, -1});
+    }
+}
+
+qsizetype IntervalModel::gallop(const TimeBase &X, qsizetype from, double x, bool upper)
+{
+    if (X.isUniform())
+        return qMax(from, upper ? X.upperBound(x) : X.lowerBound(x));
+
+    const qsizetype n = X.size();
+    auto before = [&](qsizetype i) {return upper ? X[i] <= x : X[i] < x;};
+
+    if (from >= n || !before(from)) return from;
+
+    // X[lo] is before x; double the step until it is passed
+    qsizetype lo = from, step = 1;
+
+    while (lo + step < n && before(lo + step))
+    {
+        lo += step;
+        step *= 2;
+    }
+
+    const auto left = X.begin() + (lo + 1);
+    const auto right = X.begin() + qMin(n, lo + step);
+
+    return (upper ? std::upper_bound(left, right, x) : std::lower_bound(left, right, x)) - X.begin();
+}
+
+QVector<IntervalModel::SampleRange> IntervalModel::sampleRanges(const TimeBase &X, quint64 stamp) const
+{
+    QVector<SampleRange> local;
+    QVector<SampleRange> *ranges = &local;
+
+    if (stamp != 0)
+    {
+        auto curve = std::find_if(index->begin(), index->end(),
+                                  [stamp](const CurveIndex &c) {return c.stamp == stamp;});
+
+        if (curve == index->end())
+        {
+            if (index->size() >= maxCurves)
+                index->removeFirst(); // the oldest curve state
+
+            index->append({stamp, QVector<SampleRange>(items.size(), SampleRange{-1, -1})});
+            curve = index->end() - 1;
+        }
+
+        ranges = &curve->ranges;
+    }
+    else
+        local.fill(SampleRange{-1, -1}, items.size());
+
+    // one sweep: the search for each interval starts where the previous one began
+    qsizetype from = 0;
+
+    for (qsizetype i = 0; i < items.size(); i++)
+    {
+        SampleRange &r = (*ranges)[i];
+
+        if (r.first < 0)
+        {
+            r.first = gallop(X, from, items[i].start, false);
+            r.end = gallop(X, r.first, items[i].finish, true);
+        }
+
+        from = r.first;
+    }
+
+    return *ranges;
+}
@@ -0,0 +1,84 @@
+#include "intervalstats.h"
+#include <algorithm>
+#include <cmath>
+
+IntervalStats::Row IntervalStats::compute(const QVector<double> &Y, const IntervalModel::Interval &interval,
+                                          const IntervalModel::SampleRange &range)
+{
+    if (range.isEmpty() || range.end > Y.size())
+        return {0.0, 0.0, 0.0};
+
+    const double depth1 = Y[range.first];
+    const double depth2 = Y[range.end - 1];
+    const double duration = interval.finish - interval.start;
+
+    return {std::abs(depth2 - depth1) * 100.0,
+            depth2,
+            duration > 0 ? std::abs(depth2 - depth1) / duration * 3600.0 : 0.0};
+}
+
+QVector<IntervalStats::Row> IntervalStats::rows(const DataLoader *curve, const IntervalModel &intervals)
+{
+    QVector<Row> result;
+
+    if (!curve || curve->getX().isEmpty() || curve->getY().isEmpty()) return result;
+
+    const quint64 stamp = curve->revision();
+
+    auto cached = std::find_if(curves.begin(), curves.end(),
+                               [stamp](const CurveRows &c) {return c.stamp == stamp;});
+
+    if (cached == curves.end())
+    {
+        if (curves.size() >= maxCurves)
+            curves.removeFirst(); // the oldest curve state
+
+        curves.append({stamp, {}});
+        cached = curves.end() - 1;
+    }
+
+    // the sweep runs only if some interval is new or was changed
+    QVector<IntervalModel::SampleRange> ranges;
+    QHash<quint64, Entry> current;
+
+    current.reserve(intervals.size());
+    result.reserve(intervals.size());
+
+    for (qsizetype i = 0; i < intervals.size(); i++)
+    {
+        const IntervalModel::Interval &interval = intervals[i];
+        const auto known = cached->byId.constFind(interval.id);
+
+        Entry entry;
+
+        if (known != cached->byId.constEnd() && known->start == interval.start && known->finish == interval.finish)
+            entry = *known;
+        else
+        {
+            if (ranges.isEmpty())
+                ranges = intervals.sampleRanges(curve->getX(), stamp);
+
+            entry = {interval.start, interval.finish, compute(curve->getY(), interval, ranges[i])};
+        }
+
+        current.insert(interval.id, entry);
+        result.append(entry.row);
+    }
+
+    cached->byId = std::move(current); // drops the rows of removed intervals
+
+    return result;
+}
+
+QVector<QVector<IntervalStats::Row>> IntervalStats::rows(const QVector<const DataLoader*> &loaders,
+                                                         const IntervalModel &intervals)
+{
+    QVector<QVector<Row>> result;
+
+    result.reserve(loaders.size());
+
+    for (const DataLoader *curve : loaders)
+        result.append(rows(curve, intervals));
+
+    return result;
+}
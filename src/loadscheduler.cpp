@@ -0,0 +1,81 @@
+#include "loadscheduler.h"
+#include "FileConverter.h"
+#include "dcsettings.h"
+#include <QFileInfo>
+#include <QThread>
+#include <algorithm>
+
+LoadScheduler::LoadScheduler(QObject *parent)
+    : QObject{parent}
+    , cancelFlag(std::make_shared<std::atomic<bool>>(false))
+{}
+
+LoadScheduler::~LoadScheduler()
+{
+    cancel();
+    pool.waitForDone();
+}
+
+void LoadScheduler::start(const QVector<Job> &jobs, const ConverterSetup &setup)
+{
+    if (isRunning())
+        cancel();
+
+    const int workers = DCSettings::instance().getLoadWorkers();
+    pool.setMaxThreadCount(workers > 0 ? workers : QThread::idealThreadCount());
+
+    cancelFlag = std::make_shared<std::atomic<bool>>(false);
+    batch++;
+    pending = jobs.size();
+
+    if (jobs.isEmpty())
+    {
+        emit batchFinished(false);
+        return;
+    }
+
+    // largest files first: the longest job starts earliest
+    QVector<QPair<qint64, Job>> ordered;
+    ordered.reserve(jobs.size());
+
+    for (const Job &job : jobs)
+        ordered.append({QFileInfo(job.path).size(), job});
+
+    std::stable_sort(ordered.begin(), ordered.end(),
+                     [](const auto &a, const auto &b) { return a.first > b.first; });
+
+    for (const auto &item : std::as_const(ordered))
+    {
+        const Job job = item.second;
+        const quint64 jobBatch = batch;
+        const std::shared_ptr<std::atomic<bool>> flag = cancelFlag;
+
+        pool.start([this, job, jobBatch, flag, setup]() {
+            if (!flag->load())
+            {
+                FileConverter converter(job.path, job.window);
+
+                converter.setCancelCheck([flag]() { return flag->load(); });
+                setup(&converter);
+                converter.loadFiles();
+            }
+
+            // queued after the converter's own signals, so results arrive first
+            QMetaObject::invokeMethod(this, [this, jobBatch]() { jobDone(jobBatch); },
+                                      Qt::QueuedConnection);
+        });
+    }
+}
+
+void LoadScheduler::cancel()
+{
+    cancelFlag->store(true);
+}
+
+void LoadScheduler::jobDone(quint64 jobBatch)
+{
+    if (jobBatch != batch || pending == 0) return; // a job of a replaced batch
+
+    if (--pending == 0)
+        emit batchFinished(cancelFlag->load());
+}
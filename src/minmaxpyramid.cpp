@@ -0,0 +1,189 @@
+#include "minmaxpyramid.h"
+#include <algorithm>
+#include <cmath>
+
+void MinMaxPyramid::build(const QVector<double> &data)
+{
+    levels.clear();
+
+    const int n = int(data.size());
+
+    if (n <= 1 << baseShift) return;
+
+    // every level merges pairs of blocks of the previous one
+    do
+    {
+        const int level = int(levels.size());
+        const int block = 1 << (baseShift + level);
+        const int count = (n + block - 1) / block;
+
+        levels.append(Level());
+        levels.back().minIdx.resize(count);
+        levels.back().maxIdx.resize(count);
+
+        for (int j = 0; j < count; j++)
+            fillBlock(data, level, j);
+    }
+    while (levels.back().minIdx.size() > 1);
+}
+
+void MinMaxPyramid::clear()
+{
+    levels.clear();
+}
+
+void MinMaxPyramid::truncate(const QVector<double> &data)
+{
+    const int n = int(data.size());
+
+    if (levels.isEmpty() || n <= 1 << baseShift)
+    {
+        build(data);
+        return;
+    }
+
+    for (int level = 0; level < levels.size(); level++)
+    {
+        const int block = 1 << (baseShift + level);
+        const int count = (n + block - 1) / block;
+
+        levels[level].minIdx.resize(count);
+        levels[level].maxIdx.resize(count);
+
+        // the last block lost its tail; the blocks before it are unchanged
+        fillBlock(data, level, count - 1);
+
+        if (count == 1)
+        {
+            levels.resize(level + 1);
+            break;
+        }
+    }
+}
+
+void MinMaxPyramid::fillBlock(const QVector<double> &data, int level, int j)
+{
+    int mn, mx;
+
+    if (level == 0)
+    {
+        const int begin = j << baseShift;
+        const int end = std::min(begin + (1 << baseShift), int(data.size()));
+
+        mn = mx = begin;
+
+        for (int i = begin + 1; i < end; i++)
+        {
+            if (data[i] < data[mn]) mn = i;
+            if (data[i] > data[mx]) mx = i;
+        }
+    }
+    else
+    {
+        const Level &prev = levels[level - 1];
+
+        mn = prev.minIdx[2 * j];
+        mx = prev.maxIdx[2 * j];
+
+        if (2 * j + 1 < prev.minIdx.size())
+        {
+            if (data[prev.minIdx[2 * j + 1]] < data[mn]) mn = prev.minIdx[2 * j + 1];
+            if (data[prev.maxIdx[2 * j + 1]] > data[mx]) mx = prev.maxIdx[2 * j + 1];
+        }
+    }
+
+    levels[level].minIdx[j] = mn;
+    levels[level].maxIdx[j] = mx;
+}
+
+int MinMaxPyramid::minIndex(const QVector<double> &data, int from, int to) const
+{
+    return extremeIndex(data, from, to, true);
+}
+
+int MinMaxPyramid::maxIndex(const QVector<double> &data, int from, int to) const
+{
+    return extremeIndex(data, from, to, false);
+}
+
+int MinMaxPyramid::extremeIndex(const QVector<double> &data, int from, int to, bool isMin) const
+{
+    const int n = int(data.size());
+
+    from = std::max(from, 0);
+    to = std::min(to, n - 1);
+
+    if (from > to) return -1;
+
+    if (from == 0 && to == n - 1 && !levels.isEmpty())
+        return isMin ? levels.back().minIdx[0] : levels.back().maxIdx[0];
+
+    // the largest aligned block starting at pos that ends inside the range
+    int pos = from, level = -1, best = -1;
+
+    auto fits = [&](int l) {
+        const int block = 1 << (baseShift + l);
+        return pos % block == 0 && std::min(pos + block, n) - 1 <= to;
+    };
+
+    while (pos <= to)
+    {
+        // block sizes grow towards the middle of the range and shrink after it
+        while (level + 1 < levels.size() && fits(level + 1)) level++;
+        while (level >= 0 && !fits(level)) level--;
+
+        const int block = level < 0 ? 1 : 1 << (baseShift + level);
+        const int idx = isMin ? minOf(level, pos / block) : maxOf(level, pos / block);
+
+        if (best < 0 || (isMin ? data[idx] < data[best] : data[idx] > data[best]))
+            best = idx;
+
+        pos += block;
+    }
+
+    return best;
+}
+
+void MinMaxPyramid::decimate(const QVector<double> &data, int from, int to, int buckets,
+                             QVector<int> &out) const
+{
+    const int n = int(data.size());
+
+    from = std::max(from, 0);
+    to = std::min(to, n - 1);
+
+    if (from > to || buckets < 1) return;
+
+    // samples per bucket; the coarsest level whose blocks still fit in a bucket
+    const double width = double(to - from + 1) / buckets;
+    int level = -1;
+
+    while (level + 1 < levels.size() && double(1 << (baseShift + level + 1)) <= width)
+        level++;
+
+    const int block = level < 0 ? 1 : 1 << (baseShift + level);
+    const int perBucket = std::max(1, int(std::ceil(width / block)));
+    const int lastBlock = to / block;
+
+    auto add = [&out](int index) {
+        if (out.isEmpty() || out.back() < index)
+            out.append(index);
+    };
+
+    for (int j = from / block; j <= lastBlock; j += perBucket)
+    {
+        const int jEnd = std::min(j + perBucket - 1, lastBlock);
+        int mn = minOf(level, j), mx = maxOf(level, j);
+
+        for (int k = j + 1; k <= jEnd; k++)
+        {
+            if (data[minOf(level, k)] < data[mn]) mn = minOf(level, k);
+            if (data[maxOf(level, k)] > data[mx]) mx = maxOf(level, k);
+        }
+
+        add(j * block);
+        add(std::min(mn, mx));
+        add(std::max(mn, mx));
+        add(std::min((jEnd + 1) * block, n) - 1);
+    }
+}
@@ -3,6 +3,10 @@
 #include "qcustomplot.h"
 #include <qregularexpression.h>
 #include "dcsettings.h"
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOpenGLFramebufferObject>
 
 PlotWidget::PlotWidget(QWidget *parent) // constructor
     : QCustomPlot(parent)
@@ -12,11 +16,12 @@ PlotWidget::PlotWidget(QWidget *parent) // constructor
     , line(false)
     , ctrlPressed(false)
     , przInverted(false)
+    , replotScheduler(this)
 {
     this->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);      // enable plot interactivity
     this->axisRect()->setRangeDrag(Qt::Horizontal | Qt::Vertical); // enable mouse dragging
     this->axisRect()->setRangeZoom(Qt::Horizontal | Qt::Vertical); // enable mouse wheel zoom
-    this->setOpenGl(false);  // OpenGL hardware acceleration
+    applyRenderBackend();  // OpenGL hardware acceleration if enabled and available
 
     setMouseTracking(true); // track mouse movement without pressing
 
@@ -35,6 +40,17 @@ PlotWidget::PlotWidget(QWidget *parent) // constructor
     if(!this->layer("rectangles")) // create a layer for interval rectangles
         this->addLayer("rectangles", 0); // under plots
 
+    // cursor and threshold lines get their own paint buffer: moving them redraws only this layer
+    if(!this->layer("cursor"))
+        this->addLayer("cursor", this->layer("legend"), QCustomPlot::limAbove);
+
+    cursorLayer = this->layer("cursor");
+    cursorLayer->setMode(QCPLayer::lmBuffered);
+
+    cursorLine->setLayer(cursorLayer);
+    horCursorLine->setLayer(cursorLayer);
+    loadLine->setLayer(cursorLayer);
+
     setFocusPolicy(Qt::StrongFocus);
 
     connect(this, &QCustomPlot::plottableClick, this, &PlotWidget::graphClicked);
@@ -58,17 +74,73 @@ PlotWidget::PlotWidget(QWidget *parent) // constructor
 
     connect(this->yAxis, static_cast<void (QCPAxis::*)(const QCPRange &)>(&QCPAxis::rangeChanged),
             this, &PlotWidget::mainAxisChanged);
+
+    connect(&windowPreparer, &WindowPreparer::ready, this, &PlotWidget::windowReady);
+
+    connect(&DCSettings::instance(), &DCSettings::renderBackendChanged, this, [this]() {
+        // the scheduler times every frame it draws, so the backends are compared on
+        // the views actually shown instead of in a benchmark on the GUI thread
+        const double raster = replotScheduler.meanFrameMs(false);
+        const double gl = replotScheduler.meanFrameMs(true);
+
+        if (raster > 0.0 && gl > 0.0)
+            qDebug() << "Frame time so far:" << raster << "ms raster," << gl << "ms OpenGL";
+
+        applyRenderBackend();
+        replotScheduler.request();
+    });
+}
+
+bool PlotWidget::openGlAvailable()
+{
+    // QCustomPlot draws into a framebuffer object; software renderers (Mesa llvmpipe) count too
+    static const bool available = []() {
+        QOffscreenSurface surface;
+        surface.create();
+
+        QOpenGLContext context;
+        if (!surface.isValid() || !context.create() || !context.makeCurrent(&surface))
+        {
+            qDebug() << "OpenGL: no context, raster rendering is used";
+            return false;
+        }
+
+        const bool fbo = QOpenGLFramebufferObject::hasOpenGLFramebufferObjects();
+        const char *renderer = reinterpret_cast<const char *>(context.functions()->glGetString(GL_RENDERER));
+
+        qDebug() << "OpenGL:" << (renderer ? renderer : "unknown renderer")
+                 << (fbo ? "with" : "without") << "framebuffer objects";
+
+        context.doneCurrent();
+        return fbo;
+    }();
+
+    return available;
+}
+
+void PlotWidget::applyRenderBackend()
+{
+    const bool wanted = DCSettings::instance().getUseOpenGl();
+
+    if (wanted == openGl()) return;
+
+    this->setOpenGl(wanted && openGlAvailable());
+
+    // setOpenGl falls back to raster by itself if the context cannot be set up for this widget
+    if (wanted && !openGl())
+        qDebug() << "OpenGL rendering is not available, raster rendering is used";
 }
 
 void PlotWidget::init()
 {
     this->clean();
     this->legend->setVisible(false);
-    this->replot();
+    replotScheduler.request();
 }
 
 void PlotWidget::initPlot(const QVector<const DataLoader*> &loaders)
 {
+    windowPreparer.invalidate(); // results in flight refer to the old curves
     double refRange = 0, start_x = 0, start_y = 0;
 
     this->files = loaders;
@@ -182,7 +254,7 @@ void PlotWidget::initPlot(const QVector<const DataLoader*> &loaders)
     for(int k = 0; k < axes.size(); k++)
         axes[k]->setRange(rMin * scaleFactors[k], rMax * scaleFactors[k]);
 
-    this->replot();
+    replotScheduler.request();
 
     qDebug() << "Main tablet initialization completed";
     qDebug() << "Curves loaded onto tablet:" << files.size();
@@ -213,7 +285,7 @@ void PlotWidget::updatePlot(const QCPRange &newRange) // slot for updating the b
         || currentSize / lastSize >= 1.2)
     {
         labelsDownsampling();
-        update(newRange);
+        requestUpdate(newRange);
     }
 
     emit xRangeChanged(static_cast<int>(newRange.lower));
@@ -250,7 +322,7 @@ void PlotWidget::graphClicked(QCPAbstractPlottable *plottable, int dataIndex, QM
     this->axisRect()->setRangeDragAxes(this->xAxis, axes[index]);
     axes[index]->grid()->setVisible(true);
 
-    this->replot();
+    replotScheduler.request();
 
     // connected to MainWindow::graphSelected
     emit graphSelected(true, files[index]->getName());
@@ -283,7 +355,7 @@ void PlotWidget::plotClick(QMouseEvent *event) // slot for checking click positi
     this->axisRect()->setRangeZoomAxes(this->xAxis, this->yAxis);
     this->axisRect()->setRangeDragAxes(this->xAxis, this->yAxis);
 
-    this->replot();
+    replotScheduler.request();
     activeplot = false;
     activeGraphIndex = -1;
 
@@ -321,7 +393,7 @@ void PlotWidget::mainAxisChanged(const QCPRange &newRange)
         lastAxesRange[i] = QCPRange(newMin, newMax);
     }
     lastMainRange = newRange;
-    this->replot();
+    replotScheduler.request();
 }
 
 void PlotWidget::axisChanged(const QCPRange &newRange)
@@ -396,6 +468,7 @@ QColor PlotWidget::setColor(const QString &path)
 // method for cleaning all plot data
 void PlotWidget::clean()
 {
+    windowPreparer.invalidate(); // results in flight refer to the old curves
     cleanLoad();
     this->clearGraphs();
     refIndex = 0;
@@ -417,7 +490,7 @@ void PlotWidget::clean()
     lastAxesRange.clear();
     lastXRange = QCPRange();
 
-    this->replot();
+    replotScheduler.request();
 
     qDebug() << "Tablet cleared";
 }
@@ -507,7 +580,7 @@ void PlotWidget::updateScaleFactors()
             axes[i]->setRange(0,files[i]->max());
     }
 
-    replot();
+    replotScheduler.request();
 
     qDebug() << "ScaleFactors updated";
 }
@@ -525,7 +598,8 @@ void PlotWidget::horizontalLine(const bool &state)
 void PlotWidget::showLoad(const double &lvl, DataLoader *loader, const QString &type)
 {
     int index = -1;
-    const QVector<double> *X, *Y, *przY = nullptr;
+    const TimeBase *X;
+    const QVector<double> *Y, *przY = nullptr;
     double maxPrz = 0;
 
     for(int i = 0; i < files.size(); i++)
@@ -574,23 +648,7 @@ void PlotWidget::showLoad(const double &lvl, DataLoader *loader, const QString &
                      || (fnX < przY->size() && abs((*przY)[fnX] - (*przY)[stX]) > minCandleLen);
     
                     if(shouldAdd)
-                    {
-                        QCPItemRect *pd = new QCPItemRect(this);
-                        QCPItemText *pdLabel = new QCPItemText(this);
-                        setRectangle(pd, pdLabel);
-
-                        double left = (*X)[stX];
-                        double right = (*X)[fnX];
-
-                        pd->topLeft->setCoords(left, maxY);
-                        pd->bottomRight->setCoords(right, -maxY);
-                        rectangles.append(pd);
-
-                        pdLabel->position->setCoords((left + right) / 2.0, 0.95);
-                        pdLabel->setText(QString::number(rectangles.size()));
-                        pdLabel->setPen(Qt::NoPen);
-                        recLabels.append(pdLabel);
-                    }
+                        intervalModel.append((*X)[stX], (*X)[fnX]);
                 }
 
                 st = false;
@@ -598,15 +656,17 @@ void PlotWidget::showLoad(const double &lvl, DataLoader *loader, const QString &
         }
     }
 
-    emit intervalsCreated(&rectangles);
+    intervalHeight = maxY;
+    syncIntervalItems();
 
-    labelsDownsampling();
+    emit intervalsCreated(intervalModel);
 
-    replot();
+    replotScheduler.request();
 }
 
 void PlotWidget::addLoader(const DataLoader *loader)
 {
+    windowPreparer.invalidate(); // results in flight refer to the old curves
     files.append(loader);
     QString lName = loader->getName();
 
@@ -665,13 +725,13 @@ void PlotWidget::addLoader(const DataLoader *loader)
         //         axes[k]->setRange(rMin * scaleFactors[k], rMax * scaleFactors[k]);
         // }
 
-        this->replot();
+        replotScheduler.request();
     }
 }
 
-void PlotWidget::getPDIntervals(QVector<QCPItemRect *> &intr)
+void PlotWidget::getPDIntervals(IntervalModel &intr)
 {
-    intr = rectangles;
+    intr = intervalModel;
 }
 
 void PlotWidget::getPDIntervals(QVector<QCPItemRect *> &intr, QVector<QCPItemText *> &lbls)
@@ -697,7 +757,7 @@ void PlotWidget::updateXAxis(int value)
     double range_size = this->xAxis->range().size(); // current width
     this->xAxis->setRange(value, value + range_size); // shift axis
 
-    replot();
+    replotScheduler.request();
 }
 
 void PlotWidget::xRangeControl(const QCPRange &newRange)
@@ -713,7 +773,7 @@ void PlotWidget::xRangeControl(const QCPRange &newRange)
         // forcibly limit (trim) X range
         this->xAxis->setRange(center - half, center + half);
 
-        this->replot();
+        replotScheduler.request();
     }
 }
 
@@ -723,6 +783,8 @@ void PlotWidget::updateGraph(const int &index)
     if (index < 0 || index >= this->graphCount() || index >= files.size())
         return;
 
+    windowPreparer.invalidate(); // the curve changed, a running job has its old data
+
     double currentUpper = this->xAxis->range().upper;
     double currentLower = this->xAxis->range().lower;
 
@@ -734,7 +796,7 @@ void PlotWidget::updateGraph(const int &index)
     if (!xData.isEmpty() && !yData.isEmpty()) { // redrawing plot
         this->graph(index)->setData(xData, yData);
     }
-    this->replot();
+    replotScheduler.request();
 
     qDebug() << "curve with index" << index << "updated";
 }
@@ -771,7 +833,7 @@ void PlotWidget::przCalibrated()
         }
     }
 
-    replot();
+    replotScheduler.request();
 }
 
 
@@ -899,10 +961,11 @@ void PlotWidget::cleanLoad()
 
     rectangles.clear();
     recLabels.clear();
+    intervalModel.clear();
 
     loadLine->setVisible(false);
 
-    replot();
+    replotScheduler.request();
 }
 
 void PlotWidget::setLoadLine(double lvl)
@@ -936,7 +999,7 @@ void PlotWidget::dataShifted()
 {
     QCPRange range = this->xAxis->range();
 
-    update(range);
+    requestUpdate(range);
 }
 
 void PlotWidget::updateGraph(DataLoader *loader)
@@ -956,6 +1019,8 @@ void PlotWidget::updateGraph(DataLoader *loader)
 
     if(index < 0) return;
 
+    windowPreparer.invalidate(); // the curve changed, a running job has its old data
+
     double currentUpper = this->xAxis->range().upper;
     double currentLower = this->xAxis->range().lower;
 
@@ -968,11 +1033,12 @@ void PlotWidget::updateGraph(DataLoader *loader)
         this->graph(index)->setData(xData, yData);
     }
 
-    this->replot();
+    replotScheduler.request();
 }
 
 void PlotWidget::removeLoader(const DataLoader *loader)
 {
+    windowPreparer.invalidate(); // results in flight refer to the old curves
     int index = -1;
 
     for(int i = 0; i < files.size(); i++)
@@ -1002,7 +1068,7 @@ void PlotWidget::removeLoader(const DataLoader *loader)
 
     disconnect(loader, nullptr, this, nullptr);
 
-    replot();
+    replotScheduler.request();
 }
 
 void PlotWidget::cleanAll()
@@ -1049,7 +1115,7 @@ void PlotWidget::setCalGraph(QVector<double> x, QVector<double> y)
 
     this->xAxis->setRange(x.first(), x.last());
 
-    this->replot();
+    replotScheduler.request();
 }
 
 
@@ -1077,6 +1143,8 @@ QString PlotWidget::setName(const QString &path)
 
 void PlotWidget::update(const QCPRange &range)
 {
+    windowPreparer.invalidate(); // a pending window would overwrite this one
+
     for (int i = 0; i < this->graphCount(); i++){
         QVector<double> xData, yData; // arrays for storing new data
         files[i]->update(range.lower, range.upper, xData, yData); // calling DataLoader class method
@@ -1091,10 +1159,34 @@ void PlotWidget::update(const QCPRange &range)
         }
     }
 
-    this->replot();
+    replotScheduler.request();
     lastXRange = this->xAxis->range();
 }
 
+// prepares the window of every curve on the worker; windowReady() schedules the replot
+void PlotWidget::requestUpdate(const QCPRange &range)
+{
+    QVector<WindowPreparer::Curve> curves;
+
+    for (int i = 0; i < graphCount() && i < files.size(); i++)
+        curves.append({graph(i), files[i]});
+
+    windowPreparer.request(curves, range);
+    lastXRange = range;
+}
+
+// connected to WindowPreparer::ready
+void PlotWidget::windowReady(const QCPRange &range)
+{
+    Q_UNUSED(range);
+
+    // PD/GL1 axes follow the value under the cursor, which may have just arrived
+    movePD(xAxis->range());
+    moveGl1(xAxis->range());
+
+    replotScheduler.request();
+}
+
 void PlotWidget::setRectangle(QCPItemRect *rec, QCPItemText *label)
 {
     rec->setBrush(QColor(255, 200, 200, 100));
@@ -1112,263 +1204,83 @@ void PlotWidget::setRectangle(QCPItemRect *rec, QCPItemText *label)
 }
 
 
-// method for removing movement interval from plot
-void PlotWidget::deleteInterval(const double &start, const double &finish)
+void PlotWidget::syncIntervalItems()
 {
-    QVector<QCPItemRect*> *intervals;
-    QVector<QCPItemText*> *labels;
-
-    intervals = &rectangles;
-    labels = &recLabels;
-
-    double st, fn;
-    int i = 0;
-
-    // removing specified interval
-    while (i < intervals->size() && i < labels->size())
+    // the items are reused by position, only their number follows the model
+    while(rectangles.size() > intervalModel.size())
     {
-        st = (*intervals)[i]->topLeft->key();
-        fn = (*intervals)[i]->bottomRight->key();
-
-        if(start > fn)
-        {
-            i++;
-            continue;
-        }
-
-        if(st > finish) break;
-
-        if(start > st && start <= fn && finish > fn)
-        {
-            (*intervals)[i]->bottomRight->setCoords(start, - (*intervals)[i]->topLeft->value());
-            (*labels)[i]->position->setCoords((st + start) / 2.0, 0.95);
-            i++;
-            continue;
-        }
-
-        else if(finish > st && finish < fn && (start + 0.008 <= st || start - 0.008 < st))
-        {
-            (*intervals)[i]->topLeft->setCoords(finish, (*intervals)[i]->topLeft->value());
-            (*labels)[i]->position->setCoords((finish + fn) / 2.0, 0.95);
-
-            i++;
-            continue;
-        }
-
-        else if(start <= st && finish >= fn)
-        {
-            this->removeItem((*intervals)[i]);
-            this->removeItem((*labels)[i]);
-
-            intervals->remove(i);
-            labels->remove(i);
-
-            continue;
-        }
-
-        else if(start > st && finish < fn)
-        {
-            QCPItemRect *rect1 = new QCPItemRect(this);
-            QCPItemRect *rect2 = new QCPItemRect(this);
-
-            QCPItemText *recLabel1 = new QCPItemText(this);
-            QCPItemText *recLabel2 = new QCPItemText(this);
-
-            setRectangle(rect1, recLabel1);
-            setRectangle(rect2, recLabel2);
-
-            rect1->topLeft->setCoords(st, (*intervals)[i]->topLeft->value());
-            rect1->bottomRight->setCoords(start, -(*intervals)[i]->topLeft->value());
-
-            recLabel1->position->setCoords((st + start) / 2.0, 0.95);
-            recLabel1->setText(QString::number(i + 1));
-
-            rect2->topLeft->setCoords(finish, (*intervals)[i]->topLeft->value());
-            rect2->bottomRight->setCoords(fn, -(*intervals)[i]->topLeft->value());
-
-            recLabel2->position->setCoords((finish + fn) / 2.0, 0.95);
-            recLabel2->setText(QString::number(i + 2));
-
-            this->removeItem((*intervals)[i]);
-            this->removeItem((*labels)[i]);
-
-            intervals->remove(i);
-            labels->remove(i);
-
-            intervals->insert(i, rect2);
-            intervals->insert(i, rect1);
-            labels->insert(i, recLabel2);
-            labels->insert(i, recLabel1);
-
-            i += 2;
-
-            continue;
-        }
-
-        i++;
+        this->removeItem(rectangles.takeLast());
+        this->removeItem(recLabels.takeLast());
     }
 
-    // renumbering labels
-    for (int j = 0; j < labels->size(); ++j)
-        (*labels)[j]->setText(QString::number(j + 1));
-
-    replot();
-
-    // signal for notifying about changes in movement intervals
-    // connected to DCController::intervalsChanged
-    emit intervalsChanged(*intervals);
-}
-
-
-// method for adding movement interval
-void PlotWidget::addInterval(const double &start, const double &finish)
-{
-    QVector<QCPItemRect*> *intervals;
-    QVector<QCPItemText*> *labels;
-
-    double st, fn, resStart = start;
-    int i = 0;
-
-    intervals = &rectangles;
-    labels = &recLabels;
-
-    if((*intervals).isEmpty() || (*labels).isEmpty()) return;
-
-    if(start > intervals->back()->bottomRight->key())
+    while(rectangles.size() < intervalModel.size())
     {
         QCPItemRect *rect = new QCPItemRect(this);
         QCPItemText *recLabel = new QCPItemText(this);
 
         setRectangle(rect, recLabel);
 
-        rect->topLeft->setCoords(start, (*intervals)[i]->topLeft->value());
-        rect->bottomRight->setCoords(finish, -(*intervals)[i]->topLeft->value());
-
-        recLabel->position->setCoords((start + finish) / 2.0, 0.95);
-        recLabel->setText(QString::number(i + 1));
-
-        intervals->append(rect);
-        labels->append(recLabel);
+        rectangles.append(rect);
+        recLabels.append(recLabel);
     }
 
-    else
+    for(int i = 0; i < intervalModel.size(); i++)
     {
-        while (i < intervals->size() && i < labels->size())
-        {
-            st = (*intervals)[i]->topLeft->key();
-            fn = (*intervals)[i]->bottomRight->key();
-
-            if(start > fn)
-            {
-                i++;
-                continue;
-            }
-
-            if(start >= st && finish <= fn) return;
-
-            if(start >= st && start <= fn) // first intersection
-            {
-                resStart = st;
-
-                this->removeItem((*intervals)[i]);
-                this->removeItem((*labels)[i]);
-
-                intervals->remove(i);
-                labels->remove(i);
-
-                continue;
-            }
+        const IntervalModel::Interval &interval = intervalModel[i];
 
-            if(st > finish)
-            {
-                QCPItemRect *rect = new QCPItemRect(this);
-                QCPItemText *recLabel = new QCPItemText(this);
-
-                setRectangle(rect, recLabel);
-
-                rect->topLeft->setCoords(resStart, (*intervals)[i]->topLeft->value());
-                rect->bottomRight->setCoords(finish, -(*intervals)[i]->topLeft->value());
-
-                recLabel->position->setCoords((resStart + finish) / 2.0, 0.95);
-                recLabel->setText(QString::number(i + 1));
-
-                intervals->insert(i, rect);
-                labels->insert(i,recLabel);
-
-                break;
-            }
-
-            if(finish >= st && finish <= fn)
-            {
-                double topLeft = (*intervals)[i]->topLeft->value();
-
-                this->removeItem((*intervals)[i]);
-                this->removeItem((*labels)[i]);
+        rectangles[i]->topLeft->setCoords(interval.start, intervalHeight);
+        rectangles[i]->bottomRight->setCoords(interval.finish, -intervalHeight);
 
-                intervals->remove(i);
-                labels->remove(i);
+        recLabels[i]->position->setCoords((interval.start + interval.finish) / 2.0, 0.95);
+        recLabels[i]->setText(QString::number(i + 1));
+        recLabels[i]->setVisible(true);
+    }
 
-                QCPItemRect *rect = new QCPItemRect(this);
-                QCPItemText *recLabel = new QCPItemText(this);
+    labelsDownsampling();
+}
 
-                setRectangle(rect, recLabel);
 
-                rect->topLeft->setCoords(resStart, topLeft);
-                rect->bottomRight->setCoords(fn, -topLeft);
+// method for removing movement interval from plot
+void PlotWidget::deleteInterval(const double &start, const double &finish)
+{
+    if(!intervalModel.subtract(start, finish)) return;
 
-                recLabel->position->setCoords((resStart + fn) / 2.0, 0.95);
-                recLabel->setText(QString::number(i + 1));
+    syncIntervalItems();
 
-                intervals->insert(i, rect);
-                labels->insert(i,recLabel);
+    replotScheduler.request();
 
-                break;
-            }
-
-            if(finish > fn)
-            {
-                this->removeItem((*intervals)[i]);
-                this->removeItem((*labels)[i]);
+    // signal for notifying about changes in movement intervals
+    // connected to DCController::intervalsChanged
+    emit intervalsChanged(intervalModel);
+}
 
-                intervals->remove(i);
-                labels->remove(i);
-            }
-        }
-    }
 
+// method for adding movement interval
+void PlotWidget::addInterval(const double &start, const double &finish)
+{
+    // the rectangle height comes from the threshold stage
+    if(intervalModel.isEmpty()) return;
 
+    if(!intervalModel.unite(start, finish)) return;
 
-    for (int j = 0; j < labels->size(); ++j)
-        (*labels)[j]->setText(QString::number(j + 1));
+    syncIntervalItems();
 
-    replot();
+    replotScheduler.request();
 
     // signal for notifying about changes in movement intervals
     // connected to DCController::intervalsChanged
-    emit intervalsChanged(*intervals);
+    emit intervalsChanged(intervalModel);
 }
 
 void PlotWidget::cropIntervals(const double &start, const double &finish)
 {
-    if(rectangles.isEmpty()) return;
-
-    int i = 0;
-    double st1, fn1, st2, fn2; // for storing interval start and end
+    if(!intervalModel.crop(start, finish)) return;
 
-    st1 = rectangles[0]->topLeft->key();
-    fn2 = rectangles[rectangles.size() - 1]->bottomRight->key();
+    syncIntervalItems();
 
-    if(st1 < start)
-    {
-        fn1 = start;
-        deleteInterval(st1, fn1);
-    }
+    replotScheduler.request();
 
-    if(fn2 > finish)
-    {
-        st2 = finish;
-        deleteInterval(st2, fn2);
-    }
+    emit intervalsChanged(intervalModel);
 }
 
 const DataLoader* PlotWidget::activeGraph()
@@ -1392,7 +1304,7 @@ void PlotWidget::resetActiveGraph()
     this->axisRect()->setRangeZoomAxes(this->xAxis, this->yAxis);
     this->axisRect()->setRangeDragAxes(this->xAxis, this->yAxis);
 
-    this->replot();
+    replotScheduler.request();
     activeplot = false;
     activeGraphIndex = -1;
 
@@ -1496,7 +1408,7 @@ void PlotWidget::clearGraphFocus()
     this->axisRect()->setRangeZoomAxes(this->xAxis, this->yAxis);
     this->axisRect()->setRangeDragAxes(this->xAxis, this->yAxis);
 
-    this->replot();
+    replotScheduler.request();
 }
 
 void PlotWidget::updateGraphColors()
@@ -1514,12 +1426,13 @@ void PlotWidget::updateGraphColors()
         this->graph(i)->setPen(QPen(setColor(name)));
     }
 
-    replot();
+    replotScheduler.request();
 }
 
 
 void PlotWidget::deleteLoader(const QString &lName)
 {
+    windowPreparer.invalidate(); // results in flight refer to the old curves
     int index = -1;
 
     for (int i = 0; i < files.size(); i++)
@@ -1548,7 +1461,7 @@ void PlotWidget::deleteLoader(const QString &lName)
 
     emit loaderDeleted(lName);
 
-    replot();
+    replotScheduler.request();
 }
 
 void PlotWidget::hideGraph(QString name, bool state)
@@ -1566,7 +1479,7 @@ void PlotWidget::hideGraph(QString name, bool state)
                 else
                     graph(i)->removeFromLegend();
 
-                replot();
+                replotScheduler.request();
                 return;
             }
         }
@@ -1587,7 +1500,7 @@ void PlotWidget::hideGraph(QString name, bool state)
                 else
                     graph(i)->removeFromLegend();
 
-                replot();
+                replotScheduler.request();
                 return;
             }
         }
@@ -1608,7 +1521,7 @@ void PlotWidget::hideGraph(QString name, bool state)
                 else
                     graph(i)->removeFromLegend();
 
-                replot();
+                replotScheduler.request();
                 return;
             }
         }
@@ -1630,7 +1543,7 @@ void PlotWidget::hideGraph(QString name, bool state)
                 else
                     graph(i)->removeFromLegend();
 
-                replot();
+                replotScheduler.request();
                 return;
             }
         }
@@ -1651,7 +1564,7 @@ void PlotWidget::hideGraph(QString name, bool state)
                 else
                     graph(i)->removeFromLegend();
 
-                replot();
+                replotScheduler.request();
                 return;
             }
         }
@@ -1672,7 +1585,7 @@ void PlotWidget::hideGraph(QString name, bool state)
                 else
                     graph(i)->removeFromLegend();
 
-                replot();
+                replotScheduler.request();
                 return;
             }
         }
@@ -1693,7 +1606,7 @@ void PlotWidget::hideGraph(QString name, bool state)
                 else
                     graph(i)->removeFromLegend();
 
-                replot();
+                replotScheduler.request();
                 return;
             }
         }
@@ -1709,7 +1622,7 @@ void PlotWidget::leaveEvent(QEvent *event)
 
     cursorLine->setVisible(false);
     horCursorLine->setVisible(false);
-    replot();
+    cursorLayer->replot();
 
     lastMousePos = QPoint(-1, -1);
 
@@ -1752,7 +1665,7 @@ void PlotWidget::invertPRZAxis(int state)
         }
     }
 
-    this->replot();
+    replotScheduler.request();
     przInverted = !przInverted;
 }
 
@@ -1769,7 +1682,7 @@ void PlotWidget::mouseMoveEvent(QMouseEvent *event)
         cursorLine->end->setCoords(x, yAxis->range().upper);
         cursorLine->setVisible(true);
 
-        this->replot();
+        cursorLayer->replot();
     }
 
     if(loadChooseState && ctrlPressed)
@@ -1780,7 +1693,7 @@ void PlotWidget::mouseMoveEvent(QMouseEvent *event)
         horCursorLine->end->setCoords(xAxis->range().upper, y);
         horCursorLine->setVisible(true);
 
-        this->replot();
+        cursorLayer->replot();
     }
 
     QCustomPlot::mouseMoveEvent(event);
@@ -1799,7 +1712,7 @@ void PlotWidget::keyPressEvent(QKeyEvent *event)
             cursorLine->end->setCoords(x, yAxis->range().upper);
             cursorLine->setVisible(true);
 
-            replot();
+            cursorLayer->replot();
         }
 
         if(loadChooseState && rect().contains(lastMousePos))
@@ -1810,7 +1723,7 @@ void PlotWidget::keyPressEvent(QKeyEvent *event)
             horCursorLine->end->setCoords(xAxis->range().upper, y);
             horCursorLine->setVisible(true);
 
-            replot();
+            cursorLayer->replot();
         }
     }
 
@@ -1826,7 +1739,7 @@ void PlotWidget::keyReleaseEvent(QKeyEvent *event)
         cursorLine->setVisible(false);
         horCursorLine->setVisible(false);
 
-        replot();
+        cursorLayer->replot();
     }
 
     QCustomPlot::keyReleaseEvent(event);
@@ -0,0 +1,69 @@
+#include "progressreporter.h"
+#include <QtGlobal>
+
+ProgressReporter::ProgressReporter(Sink sink, int minIntervalMs)
+    : state(std::make_shared<State>())
+{
+    state->sink = std::move(sink);
+    state->minInterval = minIntervalMs;
+    state->lastTime = -minIntervalMs; // the first report is never throttled
+    state->timer.start();
+}
+
+void ProgressReporter::update(double fraction) const
+{
+    report(offset + scale * qBound(0.0, fraction, 1.0), false);
+}
+
+void ProgressReporter::update(qint64 done, qint64 total) const
+{
+    update(total > 0 ? double(done) / double(total) : 1.0);
+}
+
+void ProgressReporter::finish() const
+{
+    report(offset + scale, true);
+}
+
+ProgressReporter ProgressReporter::sub(double from, double to) const
+{
+    ProgressReporter child = *this;
+
+    child.offset = offset + scale * qBound(0.0, from, 1.0);
+    child.scale = scale * (qBound(0.0, to, 1.0) - qBound(0.0, from, 1.0));
+
+    return child;
+}
+
+void ProgressReporter::setCancelCheck(std::function<bool()> check)
+{
+    state->cancelCheck = std::move(check);
+}
+
+bool ProgressReporter::isCancelled() const
+{
+    return state->cancelCheck && state->cancelCheck();
+}
+
+void ProgressReporter::report(double overall, bool force) const
+{
+    if (!state->sink) return;
+
+    const int percent = qBound(0, int(overall * 100.0), 100);
+    const qint64 now = state->timer.elapsed();
+
+    if (!force && percent < 100 && now - state->lastTime.load() < state->minInterval)
+        return;
+
+    // only one caller may deliver a given percentage, and never a smaller one
+    int last = state->lastPercent.load();
+
+    do
+    {
+        if (percent <= last) return;
+    }
+    while (!state->lastPercent.compare_exchange_weak(last, percent));
+
+    state->lastTime.store(now);
+    state->sink(percent);
+}
@@ -1,4 +1,6 @@
 #include "przmanager.h"
+#include "przkernels.h"
+#include <QtConcurrent>
 #include <cmath>
 #include <numbers>
 
@@ -65,12 +67,17 @@ void PrzManager::timeCorrection()
     double k1 = t_cor / (point1_2 - point1_1);
     double k2 = t_cor / (point2_2 - point2_1);
 
-    // 5. keep only the required interval
-    dvl1_X->crop(point1_1, point1_2);
-    dvl1_Z->crop(point1_1, point1_2);
+    // 5. keep only the required interval, the four axes at once
+    struct Axis
+    {
+        DataLoader *loader;
+        double from, to;
+    };
+
+    QVector<Axis> axes {{dvl1_X, point1_1, point1_2}, {dvl1_Z, point1_1, point1_2},
+                        {dvl2_X, point2_1, point2_2}, {dvl2_Z, point2_1, point2_2}};
 
-    dvl2_X->crop(point2_1, point2_2);
-    dvl2_Z->crop(point2_1, point2_2);
+    QtConcurrent::blockingMap(axes, [](Axis &a) {a.loader->crop(a.from, a.to);});
 
     qDebug() << "dvl1.size():" << dvl1_X->size() << dvl1_Z->size();
     qDebug() << "dvl2.size():" << dvl2_X->size() << dvl2_Z->size();
@@ -84,12 +91,32 @@ void PrzManager::timeCorrection()
     dvl2_X->shiftX(shift / 2 * signShift(shift2_1));
     dvl2_Z->shiftX(shift / 2 * signShift(shift2_1));
 
-    // 7. stretch/compress
-    dvl1_X->timeSync(k1);
-    dvl1_Z->timeSync(k1);
+    // 7. stretch/compress in place: the X and Z axes of a sensor share one walk over the
+    // timestamps when these match, the sensors run in parallel
+    struct Sync
+    {
+        double factor;
+        QVector<DataLoader *> axes; // axes[0] owns the timebase
+    };
+
+    QVector<Sync> syncs;
+
+    auto addSensor = [&syncs](DataLoader *axisX, DataLoader *axisZ, double k) {
+        if (axisX->sharesTime(*axisZ))
+            syncs.append({k, {axisX, axisZ}});
+        else
+        {
+            syncs.append({k, {axisX}});
+            syncs.append({k, {axisZ}});
+        }
+    };
+
+    addSensor(dvl1_X, dvl1_Z, k1);
+    addSensor(dvl2_X, dvl2_Z, k2);
+
+    qDebug() << "timeSync walks:" << syncs.size() << "for 4 axes";
 
-    dvl2_X->timeSync(k2);
-    dvl2_Z->timeSync(k2);
+    QtConcurrent::blockingMap(syncs, [](Sync &s) {DataLoader::timeSync(s.axes, s.factor);});
 
     dvl1_X->saveShift();
     dvl1_Z->saveShift();
@@ -128,59 +155,6 @@ void PrzManager::timeCorrection()
     qDebug() << "SIZE: " << dvl1_Z->size() << dvl2_Z->size();
 }
 
-void PrzManager::medianFilter(QVector<double> &data, int n)
-{
-    const int N = data.size();
-    if (N == 0 || n <= 0) return;
-
-    QVector<double> out(N);
-    std::vector<double> buf;
-    buf.reserve(2 * n + 1);
-
-    for (int i = 0; i < N; ++i)
-    {
-        const int L = std::max(0, i - n);
-        const int R = std::min(N - 1, i + n);
-        const int M = R - L + 1;
-
-        buf.assign(data.begin() + L, data.begin() + R + 1);
-
-        auto mid = buf.begin() + (M / 2);
-        std::nth_element(buf.begin(), mid, buf.end());
-
-        if (M % 2 == 1)
-        {
-            out[i] = *mid;
-        }
-
-        else
-        {
-            const double m1 = *mid;
-            const double m0 = *std::max_element(buf.begin(), mid);
-            out[i] = 0.5 * (m0 + m1);
-        }
-    }
-
-    data.swap(out);
-}
-
-void PrzManager::expFilter(QVector<double> &data, double alpha)
-{
-    const int N = data.size();
-    if (N <= 1) return;
-    if (!(alpha > 0.0 && alpha <= 1.0)) return;
-
-    double y = data[0];
-    data[0] = y;
-
-    const double a = 1.0 - alpha;
-    for (int i = 1; i < N; ++i)
-    {
-        y = alpha * data[i] + a * y;
-        data[i] = y;
-    }
-}
-
 void PrzManager::przCreate()
 {
     QString firstName = "";
@@ -223,89 +197,32 @@ void PrzManager::przCreate()
 
     timeCorrection();
 
-    QVector<double> time, oX1, oZ1, oX2, oZ2;
-
-    time.reserve(dvl1_X->size());
-    oX1.reserve(dvl1_X->size());
-    oZ1.reserve(dvl1_X->size());
-    oX2.reserve(dvl1_X->size());
-    oZ2.reserve(dvl1_X->size());
-
-    oX1 = dvl1_X->getY();
-    oX2 = dvl2_X->getY();
+    // the channels are read in place; time and resY are the only full-size arrays
+    const QVector<double> &oX1 = dvl1_X->getY();
+    const QVector<double> &oX2 = dvl2_X->getY();
 
-    oZ1 = dvl1_Z->getY();
-    oZ2 = dvl2_Z->getY();
-
-    time = dvl1_X->getX();
+    const QVector<double> &oZ1 = dvl1_Z->getY();
+    const QVector<double> &oZ2 = dvl2_Z->getY();
 
     qDebug() << "CREATE SIZE:" << oX1.size() << oX2.size() << oZ1.size() << oZ2.size();
 
-    if(time.size() != oX1.size() || time.size() != oX2.size())
-        return;
-
-    for(int i = 0; i < time.size(); i++)
-    {
-        oX1[i] -= oX2[i];
-        oZ1[i] -= oZ2[i];
-    }
-
-    oX2.clear();
-    oZ2.clear();
-
-    medianFilter(oX1, DCSettings::instance().getDvMed());
-    expFilter(oX1, DCSettings::instance().getDvExp());
-
-    medianFilter(oZ1, DCSettings::instance().getDvMed());
-    expFilter(oZ1, DCSettings::instance().getDvExp());
-
-    QVector<double> resY;
-
-    resY.reserve(oX1.size());
-
-    double delta = 0.0;
-    constexpr double pi = 3.14159265358979323846;
-
-    for(int i = 0; i < oX1.size(); i++)
-    {
-        resY.append(std::atan2(oX1[i], oZ1[i]));
-
-        if(i > 0)
-        {
-            resY[i] += delta;
-
-            const double diff = resY[i] - resY[i - 1];
-
-            if (diff > pi)
-            {
-                delta -= 2.0 * pi;
-                resY[i] -= 2.0 * pi;
-
-                if(i == 1)
-                    resY[i - 1] -= 2.0 * pi;
-            }
+    const qsizetype n = dvl1_X->getX().size();
 
-            else if (diff < -pi)
-            {
-                delta += 2.0 * pi;
-                resY[i] += 2.0 * pi;
-
-                if(i == 1)
-                    resY[i - 1] += 2.0 * pi;
-            }
-        }
-    }
-
-    double minVal = *std::min_element(resY.begin(), resY.end());
+    if(n == 0 || n != oX1.size() || n != oX2.size() || n != oZ1.size() || n != oZ2.size())
+        return;
 
-    for(int i = 1; i < resY.size(); i++)
-        resY[i] -= minVal;
+    QVector<double> time = dvl1_X->getX().toVector();
+    QVector<double> resY(n);
 
+    // difference, median, exponential filter and atan2 in one blocked pass, then a parallel unwrap
+    PrzKernels::dvlAngle(oX1.constData(), oX2.constData(),
+                         oZ1.constData(), oZ2.constData(),
+                         n,
+                         DCSettings::instance().getDvMed(),
+                         DCSettings::instance().getDvExp(),
+                         resY.data());
 
     emit przCreated(time, resY);
-
-    oX1.clear();
-    oZ1.clear();
 }
 
 void PrzManager::clear()
@@ -0,0 +1,164 @@
+#include "przparser.h"
+#include <charconv>
+#include <cstring>
+
+namespace
+{
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+// trims whitespace and a leading '+' the same way QString::toDouble/toInt accept them
+inline void trimNumber(const char *&begin, const char *&end)
+{
+    while (begin < end && isSpace(*begin)) begin++;
+    while (end > begin && isSpace(*(end - 1))) end--;
+
+    if (begin < end && *begin == '+' && end - begin > 1 && begin[1] != '-')
+        begin++;
+}
+
+// 0.0 for anything that is not entirely a number (as QString::toDouble)
+double toDouble(const char *begin, const char *end)
+{
+    trimNumber(begin, end);
+
+    // ',' is converted to '.' in a small stack copy
+    char buf[64];
+    const qsizetype len = end - begin;
+    if (len <= 0 || len >= qsizetype(sizeof(buf))) return 0.0;
+
+    for (qsizetype i = 0; i < len; i++)
+        buf[i] = begin[i] == ',' ? '.' : begin[i];
+
+    double value = 0.0;
+    auto res = std::from_chars(buf, buf + len, value);
+
+    if (res.ec != std::errc() || res.ptr != buf + len) return 0.0;
+    return value;
+}
+
+// 0 for anything that is not entirely an integer (as QString::toInt)
+int toInt(const char *begin, const char *end)
+{
+    trimNumber(begin, end);
+
+    int value = 0;
+    auto res = std::from_chars(begin, end, value);
+
+    if (res.ec != std::errc() || res.ptr != end) return 0;
+    return value;
+}
+
+// line without its "\n" / "\r\n"
+inline const char *contentEnd(const char *begin, const char *end)
+{
+    const char *nl = static_cast<const char*>(memchr(begin, '\n', end - begin));
+    const char *last = nl ? nl : end;
+
+    if (last > begin && *(last - 1) == '\r') last--;
+    return last;
+}
+
+} // namespace
+
+qsizetype PrzParser::parseHeader(const char *data, qsizetype size, double &start, double &finish)
+{
+    start = 0.0;
+    finish = 0.0;
+
+    qsizetype pos = 0;
+
+    // UTF-8 BOM (QTextStream used to drop it)
+    if (size >= 3 && memcmp(data, "\xEF\xBB\xBF", 3) == 0)
+        pos = 3;
+
+    const char *begin = data + pos;
+    const char *end = data + size;
+    const char *last = contentEnd(begin, end);
+
+    // fields are separated by single spaces: [0] start, [2] finish
+    int field = 0;
+    const char *fieldBegin = begin;
+
+    for (const char *p = begin; p <= last && field <= 2; p++)
+    {
+        if (p == last || *p == ' ')
+        {
+            if (field == 0) start = toDouble(fieldBegin, p);
+            else if (field == 2) finish = toDouble(fieldBegin, p);
+
+            field++;
+            fieldBegin = p + 1;
+        }
+    }
+
+    return lineEnd(begin, end) - data;
+}
+
+qsizetype PrzParser::countLines(const char *begin, const char *end)
+{
+    qsizetype lines = 0;
+
+    while (begin < end)
+    {
+        const char *nl = static_cast<const char*>(memchr(begin, '\n', end - begin));
+        lines++;
+
+        if (!nl) break;
+        begin = nl + 1;
+    }
+
+    return lines;
+}
+
+const char *PrzParser::lineEnd(const char *pos, const char *end)
+{
+    if (pos >= end) return end;
+
+    const char *nl = static_cast<const char*>(memchr(pos, '\n', end - pos));
+    return nl ? nl + 1 : end;
+}
+
+qsizetype PrzParser::parseRows(const char *begin, const char *end, double startPoint,
+                               double *X, double *Y)
+{
+    const int secBase = static_cast<int>(startPoint / 1000);
+    qsizetype k = 0;
+
+    while (begin < end)
+    {
+        const char *last = contentEnd(begin, end);
+
+        // fields are separated by runs of spaces: [0] value, [2] relative time (ms)
+        const char *fields[3][2];
+        int count = 0;
+        const char *p = begin;
+
+        while (count < 3)
+        {
+            while (p < last && *p == ' ') p++;
+            if (p == last) break;
+
+            fields[count][0] = p;
+            while (p < last && *p != ' ') p++;
+            fields[count][1] = p;
+            count++;
+        }
+
+        if (count == 3)
+        {
+            int relTime = toInt(fields[2][0], fields[2][1]);
+
+            X[k] = relTime / 1000.0 + secBase;
+            Y[k] = toDouble(fields[0][0], fields[0][1]);
+            k++;
+        }
+
+        begin = lineEnd(last, end);
+    }
+
+    return k;
+}
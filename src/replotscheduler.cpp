@@ -0,0 +1,74 @@
+#include "replotscheduler.h"
+#include "qcustomplot.h"
+#include <QScreen>
+
+ReplotScheduler::ReplotScheduler(QCustomPlot *plot)
+    : QObject{plot}
+    , plot(plot)
+{
+    timer.setSingleShot(true);
+    timer.setTimerType(Qt::PreciseTimer);
+
+    connect(&timer, &QTimer::timeout, this, &ReplotScheduler::replotNow);
+
+    clock.start();
+}
+
+void ReplotScheduler::request()
+{
+    if (dirty)
+    {
+        skipped++; // merged into the replot already scheduled
+        return;
+    }
+
+    dirty = true;
+
+    // the next frame boundary, or right away if the last frame is long past
+    const qint64 sinceLast = clock.elapsed() - lastReplot;
+    timer.start(int(qMax<qint64>(0, frameInterval() - sinceLast)));
+}
+
+double ReplotScheduler::meanFrameMs(bool openGl) const
+{
+    const FrameStats &frame = stats[openGl ? 1 : 0];
+
+    return frame.frames > 0 ? frame.nsecs / 1e6 / frame.frames : 0.0;
+}
+
+int ReplotScheduler::frameInterval() const
+{
+    const QScreen *screen = plot->screen();
+    const double rate = screen ? screen->refreshRate() : 60.0;
+
+    return rate > 1.0 ? qMax(1, int(1000.0 / rate)) : 16;
+}
+
+void ReplotScheduler::replotNow()
+{
+    timer.stop();
+    dirty = false;
+
+    const qint64 start = clock.nsecsElapsed();
+
+    plot->replot();
+
+    FrameStats &frame = stats[plot->openGl() ? 1 : 0];
+    frame.frames++;
+    frame.nsecs += clock.nsecsElapsed() - start;
+
+    lastReplot = clock.elapsed();
+    performed++;
+
+    if (lastReplot - lastReport >= reportIntervalMs)
+    {
+        if (skipped > 0)
+            qDebug() << "Replots:" << performed << "performed," << skipped << "skipped";
+
+        if (stats[0].frames > 0 || stats[1].frames > 0)
+            qDebug() << "Mean frame time:" << meanFrameMs(false) << "ms raster,"
+                     << meanFrameMs(true) << "ms OpenGL";
+
+        lastReport = lastReplot;
+    }
+}
@@ -0,0 +1,363 @@
+#include "resampleplan.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+
+// the walk from the source to the grid start + k * step: j only moves forward, so it is O(n + m)
+template <typename Stamp>
+struct Walker
+{
+    Stamp X;
+    qsizetype n;
+    double start, finish, step;
+
+    qsizetype k {0};
+    qsizetype j {0};
+
+    // left sample and weight of the next grid point; false past the last one
+    bool next(qsizetype &left, double &weight)
+    {
+        if (!(start + double(k) * step <= finish)) return false;
+
+        const double x = start + double(k) * step;
+
+        while (j < n - 1 && x > X(j + 1))
+            j++;
+
+        if (j + 1 > n - 1) return false;
+
+        const double xj = X(j), xj1 = X(j + 1);
+
+        if (!(x >= xj && x <= xj1 && xj1 != xj)) return false;
+
+        left = j;
+        weight = (x - xj) / (xj1 - xj);
+
+        k++;
+        return true;
+    }
+};
+
+template <typename Stamp>
+Walker<Stamp> makeWalker(Stamp X, qsizetype n, double start, double finish, double step)
+{
+    return {X, n, start, finish, step};
+}
+
+template <typename Stamp>
+void walk(Stamp X, qsizetype n, double start, double finish, double step,
+          QVector<qsizetype> &index, QVector<double> &weight)
+{
+    // the grid count can differ from the walk by one in the last bit, hence the margin;
+    // the arrays are filled through pointers, appends cost more than the walk itself
+    const double length = std::floor((finish - start) / step) + 2;
+
+    if (!(length > 0)) return;
+
+    index.resize(qsizetype(length));
+    weight.resize(qsizetype(length));
+
+    qsizetype *to = index.data();
+    double *w = weight.data();
+
+    auto walker = makeWalker(X, n, start, finish, step);
+    qsizetype k = 0;
+
+    while (k < index.size() && walker.next(to[k], w[k]))
+        k++;
+
+    index.resize(k);
+    weight.resize(k);
+}
+
+// out[k] = y[j] + w * (y[j + 1] - y[j]); the loads are near-sequential and the loop is bound
+// by memory bandwidth, an AVX2 gather of the pairs was no faster
+void interpolate(const double *y, const qsizetype *index, const double *weight,
+                 qsizetype count, double *out)
+{
+    for (qsizetype k = 0; k < count; k++)
+    {
+        const qsizetype j = index[k];
+        out[k] = y[j] + weight[k] * (y[j + 1] - y[j]);
+    }
+}
+
+constexpr qsizetype blockSize = 1024; // index, weight and output of a block stay in L1
+
+// outputs computed but not yet written, because their slots still hold source samples
+// that are read; kept in the order they are written in
+class Pending
+{
+public:
+
+    qsizetype size() const {return qsizetype(buf.size() - head);}
+
+    void push(const double *from, qsizetype n, bool reversed)
+    {
+        if (head > buf.size() / 2) // the written part is dropped now and then, not on every block
+        {
+            buf.erase(buf.begin(), buf.begin() + head);
+            head = 0;
+        }
+
+        if (reversed)
+            buf.insert(buf.end(), std::make_reverse_iterator(from + n), std::make_reverse_iterator(from));
+        else
+            buf.insert(buf.end(), from, from + n);
+    }
+
+    // the next n outputs, to [to, to + n) or, reversed, to [to - n + 1, to]
+    void pop(double *to, qsizetype n, bool reversed)
+    {
+        const double *from = buf.data() + head;
+
+        if (reversed)
+            std::reverse_copy(from, from + n, to - n + 1);
+        else
+            std::copy(from, from + n, to);
+
+        head += n;
+    }
+
+private:
+
+    std::vector<double> buf;
+
+    size_t head {0};
+};
+
+template <typename Stamp>
+void streamInPlace(Stamp X, qsizetype n, double start, double finish, double step,
+                   const QVector<QVector<double> *> &channels, qsizetype m)
+{
+    qsizetype index[blockSize];
+    double weight[blockSize], out[blockSize];
+
+    std::vector<Pending> pending(channels.size());
+    std::vector<double *> data;
+
+    // a denser grid is written from the end, its slots are ahead of the samples it reads
+    const bool backward = m > n;
+
+    // resize() grows an unshared array with realloc (reserve() would copy it)
+    for (QVector<double> *c : channels)
+    {
+        if (backward) c->resize(m);
+        data.push_back(c->data());
+    }
+
+    if (!backward)
+    {
+        auto walker = makeWalker(X, n, start, finish, step);
+        qsizetype produced = 0, written = 0;
+
+        while (produced < m)
+        {
+            const qsizetype count = std::min(blockSize, m - produced);
+
+            for (qsizetype i = 0; i < count; i++)
+                walker.next(index[i], weight[i]);
+
+            produced += count;
+
+            // the walk reads from the left sample of the last output on
+            const qsizetype free = std::max(written, std::min(index[count - 1], produced));
+
+            for (size_t c = 0; c < data.size(); c++)
+            {
+                interpolate(data[c], index, weight, count, out);
+                pending[c].push(out, count, false);
+                pending[c].pop(data[c] + written, free - written, false);
+            }
+
+            written = free;
+        }
+
+        for (size_t c = 0; c < data.size(); c++)
+            pending[c].pop(data[c] + written, m - written, false);
+    }
+    else
+    {
+        // with non-decreasing timestamps the walk down finds the pairs of the walk up
+        qsizetype j = n - 2, next = m, written = m;
+
+        while (next > 0)
+        {
+            const qsizetype count = std::min(blockSize, next);
+            const qsizetype base = next - count;
+
+            for (qsizetype k = next - 1; k >= base; k--)
+            {
+                const double x = start + double(k) * step;
+
+                while (j > 0 && X(j) >= x)
+                    j--;
+
+                const double xj = X(j), xj1 = X(j + 1);
+
+                index[k - base] = j;
+                weight[k - base] = (x - xj) / (xj1 - xj);
+            }
+
+            next = base;
+
+            // the walk reads up to the right sample of the last output
+            const qsizetype free = std::min(written, std::max(index[0] + 2, next));
+
+            for (size_t c = 0; c < data.size(); c++)
+            {
+                interpolate(data[c], index, weight, count, out);
+                pending[c].push(out, count, true);
+                pending[c].pop(data[c] + written - 1, written - free, true);
+            }
+
+            written = free;
+        }
+
+        for (size_t c = 0; c < data.size(); c++)
+            pending[c].pop(data[c] + written - 1, written, true);
+    }
+
+    for (QVector<double> *c : channels)
+    {
+        c->resize(m);
+
+        // squeeze() copies the samples to a new array, so it only runs when it frees
+        // more than it copies (a much coarser grid); a timeSync factor near 1 keeps the slots
+        if (c->capacity() - m > m)
+            c->squeeze();
+    }
+}
+
+template <typename Stamp>
+void resampleInPlace(Stamp X, qsizetype n, double step,
+                     const QVector<QVector<double> *> &channels, TimeBase &grid)
+{
+    const double start = std::ceil(X(0) / step) * step;
+    const double finish = std::floor(X(n - 1) / step) * step;
+
+    // the grid size: one walk without storing anything
+    auto counter = makeWalker(X, n, start, finish, step);
+    qsizetype m = 0, left;
+    double weight;
+
+    while (counter.next(left, weight))
+        m++;
+
+    bool ordered = true;
+
+    if (m > n)
+        for (qsizetype i = 1; i < n && ordered; i++)
+            ordered = X(i - 1) <= X(i);
+
+    if (ordered)
+        streamInPlace(X, n, start, finish, step, channels, m);
+    else
+    {
+        // the walk down needs ordered timestamps; a stored plan does not
+        QVector<qsizetype> index;
+        QVector<double> weights;
+
+        walk(X, n, start, finish, step, index, weights);
+
+        for (QVector<double> *c : channels)
+        {
+            QVector<double> result(index.size());
+
+            if (!index.isEmpty())
+                interpolate(c->constData(), index.constData(), weights.constData(), index.size(), result.data());
+
+            c->swap(result);
+        }
+    }
+
+    grid.setUniform(start, step, m);
+}
+
+} // namespace
+
+ResamplePlan ResamplePlan::aligned(const TimeBase &X, double step, double factor)
+{
+    ResamplePlan plan;
+
+    if (X.isEmpty() || !(step > 0)) return plan;
+
+    const qsizetype n = X.size();
+
+    plan.dx = step;
+    plan.sources = n;
+
+    if (factor == 1.0)
+    {
+        auto at = [&X](qsizetype i) {return X[i];};
+
+        plan.first = std::ceil(X.front() / step) * step;
+        walk(at, n, plan.first, std::floor(X.back() / step) * step, step, plan.index, plan.weight);
+    }
+    else
+    {
+        // stretched on the fly, the timestamps are not copied
+        const double x0 = X.front();
+        auto at = [&X, x0, factor](qsizetype i) {return x0 + (X[i] - x0) * factor;};
+
+        plan.first = std::ceil(at(0) / step) * step;
+        walk(at, n, plan.first, std::floor(at(n - 1) / step) * step, step, plan.index, plan.weight);
+    }
+
+    return plan;
+}
+
+ResamplePlan ResamplePlan::fromFirst(const TimeBase &X, double step)
+{
+    ResamplePlan plan;
+
+    if (X.isEmpty() || !(step > 0)) return plan;
+
+    auto at = [&X](qsizetype i) {return X[i];};
+
+    plan.first = X.front();
+    plan.dx = step;
+    plan.sources = X.size();
+
+    walk(at, X.size(), plan.first, X.back(), step, plan.index, plan.weight);
+
+    return plan;
+}
+
+bool ResamplePlan::apply(const QVector<double> &Y, QVector<double> &out) const
+{
+    if (sources == 0 || Y.size() != sources) return false;
+
+    QVector<double> result(index.size());
+
+    if (!index.isEmpty())
+        interpolate(Y.constData(), index.constData(), weight.constData(), index.size(), result.data());
+
+    out.swap(result);
+    return true;
+}
+
+bool ResamplePlan::alignedInPlace(const TimeBase &X, double step, double factor,
+                                  const QVector<QVector<double> *> &channels, TimeBase &grid)
+{
+    const qsizetype n = X.size();
+
+    if (n == 0 || !(step > 0) || channels.isEmpty()) return false;
+
+    for (const QVector<double> *c : channels)
+        if (!c || c->size() != n) return false;
+
+    if (factor == 1.0)
+        resampleInPlace([&X](qsizetype i) {return X[i];}, n, step, channels, grid);
+    else
+    {
+        const double x0 = X.front();
+        resampleInPlace([&X, x0, factor](qsizetype i) {return x0 + (X[i] - x0) * factor;}, n, step, channels, grid);
+    }
+
+    return true;
+}
@@ -44,6 +44,8 @@ void SettingsDialog::loadSettings()
 {
     ui->dnMedSpinBox->setValue(DCSettings::instance().getDnMed());
     ui->syncCheckBox->setChecked(DCSettings::instance().getTimeSync());
+    ui->cacheCheckBox->setChecked(DCSettings::instance().getUseCache());
+    ui->openGlCheckBox->setChecked(DCSettings::instance().getUseOpenGl());
     ui->dvMedSpinBox->setValue(DCSettings::instance().getDvMed());
     ui->dvExpDoubleSpinBox->setValue(DCSettings::instance().getDvExp());
     ui->minCandleLenSpinBox->setValue(static_cast<int>(DCSettings::instance().getMinCandleLen()));
@@ -70,6 +72,20 @@ void SettingsDialog::on_syncCheckBox_toggled(bool checked)
 }
 
 
+void SettingsDialog::on_cacheCheckBox_toggled(bool checked)
+{
+    delta.useCache = checked;
+    paramsChanged(true);
+}
+
+
+void SettingsDialog::on_openGlCheckBox_toggled(bool checked)
+{
+    delta.useOpenGl = checked;
+    paramsChanged(true);
+}
+
+
 void SettingsDialog::on_dnMedSpinBox_valueChanged(int arg1)
 {
     delta.dnMed = arg1;
@@ -0,0 +1,302 @@
+#include "slidingmedian.h"
+#include <utility>
+
+namespace
+{
+
+inline void compareSwap(double *a, int i, int j)
+{
+    if (a[j] < a[i]) std::swap(a[i], a[j]);
+}
+
+// optimal sorting networks for the full 3, 5 and 7 sample windows
+void sortNetwork(double *a, int n)
+{
+    switch (n)
+    {
+    case 3:
+        compareSwap(a, 1, 2); compareSwap(a, 0, 2); compareSwap(a, 0, 1);
+        break;
+
+    case 5:
+        compareSwap(a, 0, 1); compareSwap(a, 3, 4); compareSwap(a, 2, 4);
+        compareSwap(a, 2, 3); compareSwap(a, 0, 3); compareSwap(a, 0, 2);
+        compareSwap(a, 1, 4); compareSwap(a, 1, 3); compareSwap(a, 1, 2);
+        break;
+
+    case 7:
+        compareSwap(a, 0, 6); compareSwap(a, 2, 3); compareSwap(a, 4, 5);
+        compareSwap(a, 0, 2); compareSwap(a, 1, 4); compareSwap(a, 3, 6);
+        compareSwap(a, 0, 1); compareSwap(a, 2, 5); compareSwap(a, 3, 4);
+        compareSwap(a, 1, 2); compareSwap(a, 4, 6); compareSwap(a, 2, 3);
+        compareSwap(a, 4, 5); compareSwap(a, 1, 2); compareSwap(a, 3, 4);
+        compareSwap(a, 5, 6);
+        break;
+    }
+}
+
+// partial windows at the edges
+void insertionSort(double *a, int n)
+{
+    for (int i = 1; i < n; i++)
+        for (int j = i; j > 0 && a[j] < a[j - 1]; j--)
+            std::swap(a[j], a[j - 1]);
+}
+
+} // namespace
+
+SlidingMedian::SlidingMedian(int radius, Edge edge)
+    : r(radius)
+    , width(2 * radius + 1)
+    , edge(edge)
+    , network(radius <= networkRadius)
+    , values(width)
+{
+    if (!network)
+    {
+        where.resize(width);
+        lo.reserve(width);
+        hi.reserve(width);
+    }
+}
+
+void SlidingMedian::reset()
+{
+    pushed = 0;
+    oldest = 0;
+    next = 0;
+    lo.clear();
+    hi.clear();
+}
+
+bool SlidingMedian::push(double value, double &median)
+{
+    if (edge == Edge::Clamp)
+    {
+        // the first sample also stands for the r samples before the start
+        int copies = pushed == 0 ? r + 1 : 1;
+
+        while (copies-- > 0)
+            insert(value);
+
+        pushed++;
+        last = value;
+
+        if (size() < width) return false;
+
+        median = this->median();
+        return true;
+    }
+
+    insert(value);
+    pushed++;
+
+    // window [k - 2r, k] (cut at 0) is centred on sample k - r
+    if (pushed <= r) return false;
+
+    median = this->median();
+    return true;
+}
+
+qsizetype SlidingMedian::flush(double *out)
+{
+    qsizetype k = 0;
+
+    if (pushed == 0) return 0;
+
+    if (edge == Edge::Clamp)
+    {
+        // the last sample stands for the r samples after the end
+        for (int i = 0; i < r; i++)
+        {
+            insert(last);
+
+            if (size() == width)
+                out[k++] = median();
+        }
+    }
+
+    else
+    {
+        // windows [j - r, end) shrink towards the end
+        for (qint64 j = qMax<qint64>(0, pushed - r); j < pushed; j++)
+        {
+            while (oldest < j - r)
+                evict();
+
+            out[k++] = median();
+        }
+    }
+
+    reset();
+    return k;
+}
+
+void SlidingMedian::filter(QVector<double> &data, int radius, Edge edge)
+{
+    if (data.isEmpty() || radius < 1) return;
+
+    SlidingMedian engine(radius, edge);
+    QVector<double> result(data.size());
+
+    double *out = result.data();
+    qsizetype k = 0;
+
+    for (double v : std::as_const(data))
+    {
+        if (engine.push(v, out[k]))
+            k++;
+    }
+
+    engine.flush(out + k);
+    data.swap(result);
+}
+
+void SlidingMedian::insert(double value)
+{
+    if (size() == width)
+        evict();
+
+    const int slot = int(next % width);
+    values[slot] = value;
+    next++;
+
+    if (network) return;
+
+    if (lo.empty() || value <= values[lo[0]])
+        heapPush(lo, true, slot);
+    else
+        heapPush(hi, false, slot);
+
+    rebalance();
+}
+
+void SlidingMedian::evict()
+{
+    const int slot = int(oldest % width);
+    oldest++;
+
+    if (network) return;
+
+    if (where[slot] >= 0)
+        heapRemove(lo, true, where[slot]);
+    else
+        heapRemove(hi, false, ~where[slot]);
+
+    rebalance();
+}
+
+double SlidingMedian::median() const
+{
+    const int m = size();
+
+    if (network)
+    {
+        double buf[2 * networkRadius + 1];
+
+        for (int i = 0; i < m; i++)
+            buf[i] = values[(oldest + i) % width];
+
+        if (m == width)
+            sortNetwork(buf, m);
+        else
+            insertionSort(buf, m);
+
+        if (m % 2 == 1)
+            return buf[m / 2];
+
+        return 0.5 * (buf[m / 2 - 1] + buf[m / 2]);
+    }
+
+    // lo holds the (m + 1) / 2 smallest values
+    if (m % 2 == 1)
+        return values[lo[0]];
+
+    return 0.5 * (values[lo[0]] + values[hi[0]]);
+}
+
+void SlidingMedian::rebalance()
+{
+    const std::size_t target = std::size_t(size() + 1) / 2;
+
+    while (lo.size() > target)
+    {
+        const int slot = lo[0];
+        heapRemove(lo, true, 0);
+        heapPush(hi, false, slot);
+    }
+
+    while (lo.size() < target)
+    {
+        const int slot = hi[0];
+        heapRemove(hi, false, 0);
+        heapPush(lo, true, slot);
+    }
+}
+
+bool SlidingMedian::before(bool isLo, int a, int b) const
+{
+    return isLo ? values[a] > values[b] : values[a] < values[b];
+}
+
+void SlidingMedian::place(std::vector<int> &heap, bool isLo, int pos, int slot)
+{
+    heap[pos] = slot;
+    where[slot] = isLo ? pos : ~pos;
+}
+
+void SlidingMedian::siftUp(std::vector<int> &heap, bool isLo, int pos)
+{
+    const int slot = heap[pos];
+
+    while (pos > 0)
+    {
+        const int parent = (pos - 1) / 2;
+        if (!before(isLo, slot, heap[parent])) break;
+
+        place(heap, isLo, pos, heap[parent]);
+        pos = parent;
+    }
+
+    place(heap, isLo, pos, slot);
+}
+
+void SlidingMedian::siftDown(std::vector<int> &heap, bool isLo, int pos)
+{
+    const int n = int(heap.size());
+    const int slot = heap[pos];
+
+    while (true)
+    {
+        int child = 2 * pos + 1;
+        if (child >= n) break;
+
+        if (child + 1 < n && before(isLo, heap[child + 1], heap[child]))
+            child++;
+
+        if (!before(isLo, heap[child], slot)) break;
+
+        place(heap, isLo, pos, heap[child]);
+        pos = child;
+    }
+
+    place(heap, isLo, pos, slot);
+}
+
+void SlidingMedian::heapPush(std::vector<int> &heap, bool isLo, int slot)
+{
+    heap.push_back(slot);
+    siftUp(heap, isLo, int(heap.size()) - 1);
+}
+
+void SlidingMedian::heapRemove(std::vector<int> &heap, bool isLo, int pos)
+{
+    const int lastSlot = heap.back();
+    heap.pop_back();
+
+    if (pos == int(heap.size())) return;
+
+    place(heap, isLo, pos, lastSlot);
+    siftUp(heap, isLo, pos);
+    siftDown(heap, isLo, where[lastSlot] >= 0 ? where[lastSlot] : ~where[lastSlot]);
+}
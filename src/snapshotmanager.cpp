@@ -8,6 +8,7 @@
 #include <QMutexLocker>
 #include <algorithm>
 #include "dcsettings.h"
+#include "progressreporter.h"
 
 // --- SnapshotSaveWorker declarations ---
 SnapshotSaveWorker::SnapshotSaveWorker(const QString &savePath,
@@ -28,8 +29,8 @@ void SnapshotSaveWorker::process()
         return;
     }
 
-    int percent = 0;
-    emit progress(percent);
+    ProgressReporter reporter([this](int percent) { emit progress(percent); });
+    reporter.update(0.0);
 
     QFile file(savePath);
 
@@ -44,7 +45,7 @@ void SnapshotSaveWorker::process()
 
     try
     {
-        out << qint32(1); // format version
+        out << qint32(2); // format version (2: uniform timebases stored as grid parameters)
         out << description;
         out << qint32(loadersInfo.size()); // loader count
 
@@ -62,8 +63,21 @@ void SnapshotSaveWorker::process()
             const auto X = loadersInfo[i].X;
             const auto Y = loadersInfo[i].Y;
 
+            // each loader gets an equal share: first half X, second half Y
+            const ProgressReporter loaderPart = reporter.sub(double(i) / loadersInfo.size(),
+                                                             double(i + 1) / loadersInfo.size());
+
+            const TimeBase &grid = loadersInfo[i].grid;
+
             out << loadersInfo[i].name;
-            out << qint32(X.size());
+            out << qint32(Y.size());
+            out << qint8(grid.isUniform());
+
+            if(grid.isUniform())
+            {
+                out << grid.gridStart() << grid.gridStep()
+                    << qint64(grid.gridBase()) << grid.shiftOffset();
+            }
 
             // write data in blocks
             const int blockSize = 10000;
@@ -85,9 +99,7 @@ void SnapshotSaveWorker::process()
                     reinterpret_cast<const char*>(X.constData() + j),
                     currentBlockSize * sizeof(double));
 
-                percent = (i * 50 + (j * 50) / X.size()) / loadersInfo.size();
-
-                emit progress(percent);
+                loaderPart.sub(0.0, 0.5).update(j + currentBlockSize, X.size());
             }
 
             for(int j = 0; j < Y.size(); j += blockSize)
@@ -108,16 +120,13 @@ void SnapshotSaveWorker::process()
                     reinterpret_cast<const char*>(Y.constData() + j),
                     currentBlockSize * sizeof(double));
 
-                int loaderProgress = 50 + (j * 50) / Y.size();  // 50-100%
-                percent = (i * 100 + loaderProgress) / loadersInfo.size();
-
-                emit progress(percent);
+                loaderPart.sub(0.5, 1.0).update(j + currentBlockSize, Y.size());
             }
         }
 
         file.close();
 
-        emit progress(100);
+        reporter.finish();
         emit finished(true, savePath);
 
     } catch(const std::exception &e) {
@@ -145,8 +154,8 @@ void SnapshotLoadWorker::process()
         return;
     }
 
-    int percent = 0;
-    emit progress(percent);
+    ProgressReporter reporter([this](int percent) { emit progress(percent); });
+    reporter.update(0.0);
 
     QFile file(loadPath);
     if(!file.open(QIODevice::ReadOnly))
@@ -174,7 +183,7 @@ void SnapshotLoadWorker::process()
         in >> version; // format version
         in >> description;
 
-        if(version != 1)
+        if(version != 1 && version != 2)
             throw std::runtime_error("Unsupported snapshot format version");
 
         in >> loadersCount; // loader count
@@ -193,28 +202,43 @@ void SnapshotLoadWorker::process()
 
             LoaderInfo info;
             qint32 dataSize;
+            qint8 uniform = 0;
             QString name;
 
             in >> name >> dataSize;
+
+            if(version >= 2)
+                in >> uniform;
             
             info.name = name;
-            
-            info.X.resize(dataSize);
             info.Y.resize(dataSize);
 
-            in.readRawData(reinterpret_cast<char*>(info.X.data()), 
-                          dataSize * sizeof(double));
+            if(uniform)
+            {
+                double start, step, offset;
+                qint64 base;
+
+                in >> start >> step >> base >> offset;
+                info.grid.setGrid(start, step, base, offset, dataSize);
+            }
+            else
+            {
+                info.X.resize(dataSize);
+
+                in.readRawData(reinterpret_cast<char*>(info.X.data()), 
+                              dataSize * sizeof(double));
+            }
+
             in.readRawData(reinterpret_cast<char*>(info.Y.data()), 
                           dataSize * sizeof(double));
             
             result.append(info);
 
-            int percent = 10 + ((i + 1) * 80 / loadersCount);
-            emit progress(percent);
+            reporter.sub(0.1, 0.9).update(i + 1, loadersCount);
         }
 
         file.close();
-        emit progress(100);
+        reporter.finish();
         emit finished(true, result);
     }
     catch(const std::exception& e)
@@ -307,10 +331,16 @@ void SnapshotManager::createSnapshotAsync(const QVector<DataLoader*> &loaders,
         if(!loaders[i]) continue;
         SnapshotSaveWorker::loaderInfo info;
         info.name = loaders[i]->getName();
-        info.X = loaders[i]->getX();
+        const TimeBase &X = loaders[i]->getX();
+
+        if(X.isUniform())
+            info.grid = X;
+        else
+            info.X = X.toVector(); // implicitly shared with the loader
+
         info.Y = loaders[i]->getY();
 
-        if(!(info.X.isEmpty() || info.Y.isEmpty()))
+        if(!(X.isEmpty() || info.Y.isEmpty()))
             loadersInfo.append(info);
     }
 
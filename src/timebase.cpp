@@ -0,0 +1,100 @@
+#include "timebase.h"
+#include <algorithm>
+#include <cmath>
+
+TimeBase TimeBase::uniformGrid(double start, double step, qsizetype count)
+{
+    TimeBase tb;
+    tb.setUniform(start, step, count);
+    return tb;
+}
+
+void TimeBase::setExplicit(const QVector<double> *values)
+{
+    this->values = values;
+    uniform = false;
+    first = dx = offset = 0.0;
+    base = count = 0;
+}
+
+void TimeBase::setUniform(double start, double step, qsizetype count)
+{
+    setGrid(start, step, 0, 0.0, count);
+}
+
+void TimeBase::setGrid(double start, double step, qsizetype base, double offset, qsizetype count)
+{
+    this->values = nullptr;
+    this->uniform = true;
+    this->first = start;
+    this->dx = step;
+    this->base = base;
+    this->offset = offset;
+    this->count = count;
+}
+
+qsizetype TimeBase::lowerBound(double x) const
+{
+    if (!uniform)
+    {
+        if (!values) return 0;
+
+        // with a pending shift compare the shifted values themselves, not x - offset
+        return offset == 0.0 ? std::lower_bound(values->begin(), values->end(), x) - values->begin()
+                             : std::lower_bound(begin(), end(), x) - begin();
+    }
+
+    if (count == 0) return 0;
+
+    // estimate from the grid, then settle on the exact boundary of the computed values
+    double estimate = std::ceil((x - offset - first) / dx) - double(base);
+    qsizetype k = qsizetype(qBound(0.0, estimate, double(count)));
+
+    while (k > 0 && (*this)[k - 1] >= x) k--;
+    while (k < count && (*this)[k] < x) k++;
+
+    return k;
+}
+
+qsizetype TimeBase::upperBound(double x) const
+{
+    if (!uniform)
+    {
+        if (!values) return 0;
+
+        return offset == 0.0 ? std::upper_bound(values->begin(), values->end(), x) - values->begin()
+                             : std::upper_bound(begin(), end(), x) - begin();
+    }
+
+    if (count == 0) return 0;
+
+    double estimate = std::floor((x - offset - first) / dx) - double(base) + 1.0;
+    qsizetype k = qsizetype(qBound(0.0, estimate, double(count)));
+
+    while (k > 0 && (*this)[k - 1] > x) k--;
+    while (k < count && (*this)[k] <= x) k++;
+
+    return k;
+}
+
+qsizetype TimeBase::indexOf(double x) const
+{
+    if (!uniform && offset == 0.0)
+        return values ? values->indexOf(x) : -1;
+
+    const qsizetype k = lowerBound(x);
+    return (k < size() && (*this)[k] == x) ? k : -1;
+}
+
+QVector<double> TimeBase::toVector() const
+{
+    if (!uniform && offset == 0.0)
+        return values ? *values : QVector<double>();
+
+    QVector<double> result(size());
+
+    for (qsizetype i = 0; i < result.size(); i++)
+        result[i] = (*this)[i];
+
+    return result;
+}
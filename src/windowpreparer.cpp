@@ -0,0 +1,235 @@
+#include "windowpreparer.h"
+#include <cmath>
+#include <memory>
+
+WindowPreparer::WindowPreparer(QObject *parent)
+    : QObject{parent}
+{
+    pool.setMaxThreadCount(1);
+    clock.start();
+}
+
+WindowPreparer::~WindowPreparer()
+{
+    invalidate();
+    pool.waitForDone();
+}
+
+void WindowPreparer::request(const QVector<Curve> &curves, const QCPRange &range)
+{
+    int level;
+    qint64 slot;
+
+    quantize(range, level, slot);
+    trackPan(range, level, slot);
+
+    lastCurves = curves;
+
+    if (busy)
+    {
+        // only the latest window matters; it starts when the running job is done
+        pendingCurves = curves;
+        pendingRange = range;
+        hasPending = true;
+        interrupt = true;
+        return;
+    }
+
+    show(curves, range);
+}
+
+void WindowPreparer::invalidate()
+{
+    generation++;
+    interrupt = true; // the results of a running prefetch are dropped anyway
+    hasPending = false;
+    pendingCurves.clear();
+    lastCurves.clear();
+    direction = 0;
+    cache.clear();
+}
+
+void WindowPreparer::quantize(const QCPRange &range, int &level, qint64 &slot)
+{
+    const double width = std::max(range.size(), 1e-6);
+
+    level = int(std::ceil(levelsPerOctave * std::log2(width)));
+
+    const double step = std::exp2(double(level) / levelsPerOctave) / 2.0;
+
+    slot = qint64(std::floor(range.lower / step));
+}
+
+QCPRange WindowPreparer::window(int level, qint64 slot)
+{
+    // not narrower than the view and starting at most half a width before it;
+    // DataLoader::update adds one width on each side, so the view stays covered
+    const double width = std::exp2(double(level) / levelsPerOctave);
+    const double lower = double(slot) * width / 2.0;
+
+    return QCPRange(lower, lower + width);
+}
+
+void WindowPreparer::trackPan(const QCPRange &range, int level, qint64 slot)
+{
+    const qint64 now = clock.elapsed();
+    const double center = range.center();
+
+    direction = 0;
+
+    // a zoom or a pause starts the tracking over
+    if (lastTime >= 0 && level == lastLevel && now > lastTime && now - lastTime < 1000)
+    {
+        const double velocity = (center - lastCenter) * 1000.0 / double(now - lastTime);
+        const double step = std::exp2(double(level) / levelsPerOctave) / 2.0;
+
+        direction = velocity > 0 ? 1 : (velocity < 0 ? -1 : 0);
+        ahead = qBound(1, int(std::ceil(std::abs(velocity) * lookaheadMs / 1000.0 / step)), maxAhead);
+    }
+
+    lastTime = now;
+    lastCenter = center;
+    lastLevel = level;
+    lastSlot = slot;
+}
+
+void WindowPreparer::show(const QVector<Curve> &curves, const QCPRange &range)
+{
+    int level;
+    qint64 slot;
+
+    quantize(range, level, slot);
+
+    const QCPRange snapped = window(level, slot);
+
+    QVector<QPointer<QCPGraph>> graphs;
+    QVector<QSharedPointer<QCPGraphDataContainer>> shown;
+    QVector<Task> tasks;
+
+    cache.setMaxCost(std::max<qsizetype>(1, curves.size()) * windowsPerCurve);
+
+    // the copies are taken here, on the GUI thread; the job reads only them
+    for (const Curve &curve : curves)
+    {
+        if (!curve.graph || !curve.loader) continue;
+
+        const WindowKey key {curve.loader->revision(), level, slot};
+
+        graphs.append(curve.graph);
+        shown.append(QSharedPointer<QCPGraphDataContainer>());
+
+        if (QSharedPointer<QCPGraphDataContainer> *hit = cache.object(key))
+            shown.back() = *hit;
+        else
+            tasks.append({int(shown.size()) - 1, curve.loader->plotSource(), snapped, key, {}});
+    }
+
+    auto swapIn = [this, graphs, shown, range](const QVector<Task> &done) mutable {
+        for (const Task &task : done)
+            shown[task.index] = task.data;
+
+        for (int i = 0; i < graphs.size(); i++)
+            if (!graphs[i].isNull() && !shown[i].isNull())
+                graphs[i]->setData(shown[i]);
+
+        emit ready(range);
+    };
+
+    if (tasks.isEmpty())
+    {
+        swapIn({}); // every window was cached
+        prefetch();
+        return;
+    }
+
+    run(tasks, swapIn);
+}
+
+void WindowPreparer::prefetch()
+{
+    if (busy || direction == 0 || lastCurves.isEmpty()) return;
+
+    QVector<Task> tasks;
+
+    for (int k = 1; k <= ahead; k++)
+    {
+        const qint64 slot = lastSlot + direction * k;
+
+        for (const Curve &curve : std::as_const(lastCurves))
+        {
+            if (!curve.loader) continue;
+
+            const WindowKey key {curve.loader->revision(), lastLevel, slot};
+
+            if (!cache.contains(key))
+                tasks.append({-1, curve.loader->plotSource(), window(lastLevel, slot), key, {}});
+        }
+    }
+
+    if (!tasks.isEmpty())
+        run(tasks, [](const QVector<Task> &) {}, true); // the results only go into the cache
+}
+
+void WindowPreparer::run(const QVector<Task> &tasks, std::function<void(const QVector<Task> &)> done,
+                         bool interruptible)
+{
+    busy = true;
+    jobDone = std::move(done);
+    interrupt = false;
+
+    const quint64 jobGeneration = generation;
+
+    pool.start([this, tasks, jobGeneration, interruptible]() mutable {
+        QVector<double> xData, yData;
+
+        for (Task &task : tasks)
+        {
+            // the windows not prepared yet keep no data and are not cached
+            if (interruptible && interrupt.load(std::memory_order_relaxed))
+            {
+                task.source.reset();
+                continue;
+            }
+
+            task.source->update(task.range.lower, task.range.upper, xData, yData);
+
+            QVector<QCPGraphData> points(xData.size());
+
+            for (int j = 0; j < xData.size(); j++)
+                points[j] = QCPGraphData(xData[j], yData[j]);
+
+            task.data = QSharedPointer<QCPGraphDataContainer>::create();
+            task.data->set(points, true); // keys are ascending
+            task.source.reset();          // release the copy on the worker
+        }
+
+        QMetaObject::invokeMethod(this, [this, jobGeneration, tasks]() {
+            finish(jobGeneration, tasks);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void WindowPreparer::finish(quint64 jobGeneration, const QVector<Task> &tasks)
+{
+    busy = false;
+
+    const auto done = std::move(jobDone);
+    jobDone = nullptr;
+
+    if (jobGeneration == generation)
+    {
+        for (const Task &task : tasks)
+            if (!task.data.isNull())
+                cache.insert(task.key, new QSharedPointer<QCPGraphDataContainer>(task.data));
+
+        if (done) done(tasks);
+    }
+
+    if (hasPending)
+    {
+        hasPending = false;
+        show(pendingCurves, pendingRange);
+    }
+    else
+        prefetch();
+}
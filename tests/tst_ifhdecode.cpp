@@ -0,0 +1,255 @@
+#include <QtTest>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QColor>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <optional>
+#include "FileConverter.h"
+#include "dcsettings.h"
+
+/*
+ * Compares the mapped IFH decoder (FileConverter::loadFiles) with the
+ * frame-by-frame QFile reader it replaced, on the fixtures in tests/data and
+ * on the recorded files in $DEPTHCALC_RECORDINGS.
+ */
+class TestIfhDecode : public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void decode_data();
+
+    void decode();
+};
+
+namespace
+{
+
+struct Decoded
+{
+    QVector<double> X;
+    QVector<double> Y;
+    QVector<double> addY;
+
+    double startPoint {0.0};
+    double finishPoint {0.0};
+    double refStartPoint {0.0};
+    double refFinishPoint {0.0};
+};
+
+// the reader used before the mapped decoder (loadIFH1/loadIFHdvl), without progress reporting
+void referenceIFH(const QString &path, bool dualAxis, Decoded &d)
+{
+    const int frame = 16;
+    const int step = QFileInfo(path).fileName().contains("DN", Qt::CaseInsensitive) ? 100 : 8;
+
+    QFile ifh(path);
+
+    if (!ifh.open(QIODevice::ReadOnly))
+        return;
+
+    char buf[frame];
+
+    QDataStream in(&ifh);
+
+    int msCount = 1000;
+    unsigned k = 0;
+    double lastSec = 0.0;
+
+    while (!in.atEnd() && ifh.bytesAvailable() >= frame)
+    {
+        if (ifh.read(buf, frame) != frame) break;
+        const quint8* b = reinterpret_cast<const quint8*>(buf);
+
+        quint32 sec  = (quint32(b[0]) << 16) | (quint32(b[1]) << 8) | quint32(b[2]);
+
+        if(k == 0)
+            msCount = (quint32(b[3]) << 8)  | quint32(b[4]);
+
+        qint32 xNumRaw = (qint32(b[7]) << 16) | (qint32(b[8]) << 8) | qint32(b[9]);
+        if (b[7] & 0x80) xNumRaw |= 0xFF000000;
+
+        qint32 zNumRaw = (qint32(b[13]) << 16) | (qint32(b[14]) << 8) | qint32(b[15]);
+        if (b[13] & 0x80) zNumRaw |= 0xFF000000;
+
+        if (std::all_of(b, b + frame, [](quint8 v){ return v == 0xFF; }))
+            break;
+
+        if((double(sec) > lastSec && msCount == 1000) || k == 0)
+        {
+            msCount = 0;
+            lastSec = double(sec);
+        }
+
+        else if(double(sec) > lastSec && msCount <= 1000)
+        {
+            while (msCount < 1000)
+            {
+                d.X.append(lastSec + double(msCount) / 1000.0);
+                d.Y.append(d.Y.back());
+
+                if (dualAxis)
+                    d.addY.append(d.addY.back());
+
+                msCount += step;
+            }
+
+            msCount = 0;
+            lastSec = sec;
+        }
+
+        if(msCount >= 1000) continue;
+
+        k++;
+
+        d.X.append(double(sec) + double(msCount) / 1000.0);
+        d.Y.append(double(zNumRaw));
+
+        if (dualAxis)
+            d.addY.append(double(xNumRaw));
+
+        msCount += step;
+    }
+
+    bool flag = true;
+    ifh.seek(ifh.size() - 61);
+    for (int i = 0; i < 5; i++){
+        if(!in.atEnd()){
+            in >> buf[i];
+        }
+        else break;
+        if (buf[i] != '#') {flag = false; break;}
+    }
+
+    if (!flag) return;
+
+    QRegularExpression datePattern(R"((\d{2}\.\d{2}\.\d{4} \d{2}:\d{2}:\d{2}))");
+    for (int i = 0; i < 2; i ++){
+        QString text = QString::fromLatin1(ifh.read(20));
+
+        QRegularExpressionMatch match = datePattern.match(text);
+        if (match.hasMatch())
+        {
+            QDateTime dateTime = QDateTime::fromString(match.captured(1), "dd.MM.yyyy HH:mm:ss").toUTC();
+
+            if (i == 0)
+                d.startPoint = dateTime.toSecsSinceEpoch();
+            else
+                d.finishPoint = dateTime.toSecsSinceEpoch();
+
+            ifh.seek(ifh.pos() + 2);
+            text = QString::fromLatin1(ifh.read(6));
+            bool ok;
+            if (i == 0)
+                d.refStartPoint = text.toUInt(&ok,16);
+            else
+                d.refFinishPoint = text.toUInt(&ok,16);
+        }
+    }
+}
+
+// the median applied to DN files before the shared SlidingMedian
+void referenceMedian(QVector<double> &data, int radius)
+{
+    if (data.isEmpty() || radius < 1) return;
+
+    QVector<double> result(data.size());
+
+    for (int i = 0; i < data.size(); ++i)
+    {
+        QVector<double> window;
+        for (int j = -radius; j <= radius; ++j)
+        {
+            int idx = i + j;
+            if (idx < 0) idx = 0;
+            if (idx >= data.size()) idx = data.size() - 1;
+            window.append(data[idx]);
+        }
+
+        std::sort(window.begin(), window.end());
+        result[i] = window[radius];
+    }
+
+    data.swap(result);
+}
+
+void addFiles(const QString &dir)
+{
+    const QStringList files = QDir(dir).entryList({"*.ifh"}, QDir::Files, QDir::Name);
+
+    for (const QString &name : files)
+        QTest::newRow(qPrintable(name)) << QDir(dir).filePath(name);
+}
+
+} // namespace
+
+void TestIfhDecode::decode_data()
+{
+    QTest::addColumn<QString>("path");
+
+    addFiles(DEPTHCALC_TEST_DATA);
+
+    const QString recordings = qEnvironmentVariable("DEPTHCALC_RECORDINGS");
+
+    if (!recordings.isEmpty())
+        addFiles(recordings);
+}
+
+void TestIfhDecode::decode()
+{
+    QFETCH(QString, path);
+
+    const QString name = QFileInfo(path).fileName();
+    const bool dualAxis = name.contains("DV", Qt::CaseInsensitive) && !name.contains("DN", Qt::CaseInsensitive);
+    const bool dn = name.contains("DN", Qt::CaseInsensitive);
+
+    if (!dn && !dualAxis && !name.contains("MK", Qt::CaseInsensitive) && !name.contains("KM", Qt::CaseInsensitive))
+        QSKIP("not a DN/DV/MK file");
+
+    Decoded expected;
+    referenceIFH(path, dualAxis, expected);
+
+    if (dn)
+        referenceMedian(expected.Y, DCSettings::instance().getDnMed());
+
+    // a copy, so that no .dccache sidecar is read or left next to the source
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QString copy = dir.filePath(name);
+    QVERIFY(QFile::copy(path, copy));
+
+    FileConverter converter;
+    converter.set_file_path(copy);
+
+    QSharedPointer<LoadedFile> loaded;
+    connect(&converter, &FileConverter::finished, this, [&](QSharedPointer<LoadedFile> file) {loaded = file;});
+
+    converter.loadFiles();
+
+    QVERIFY(loaded);
+    QCOMPARE(loaded->dualAxis, dualAxis);
+    QCOMPARE(loaded->X, expected.X);
+    QCOMPARE(loaded->Y, expected.Y);
+    QCOMPARE(loaded->addY, expected.addY);
+
+    double start, finish, startRef, finishRef;
+    converter.getSyncPoints(start, finish, startRef, finishRef);
+
+    QCOMPARE(start, expected.startPoint);
+    QCOMPARE(finish, expected.finishPoint);
+    QCOMPARE(startRef, expected.refStartPoint);
+    QCOMPARE(finishRef, expected.refFinishPoint);
+}
+
+QTEST_GUILESS_MAIN(TestIfhDecode)
+
+#include "tst_ifhdecode.moc"
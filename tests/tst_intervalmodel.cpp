@@ -0,0 +1,520 @@
+#include <QtTest>
+#include <QRandomGenerator>
+#include <algorithm>
+#include "intervalmodel.h"
+#include "timebase.h"
+
+/*
+ * Checks IntervalModel against the loops PlotWidget used to edit its
+ * rectangles with (addInterval, deleteInterval, cropIntervals), and its
+ * sample ranges and their cache against a plain search over the curve.
+ */
+class TestIntervalModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void trim();
+
+    void split();
+
+    void merge();
+
+    void crop();
+
+    void parity_data();
+
+    void parity();
+
+    void sampleRanges();
+
+    void cacheAfterEdit();
+};
+
+namespace
+{
+
+struct Span
+{
+    double start;
+    double finish;
+};
+
+// PlotWidget::deleteInterval before IntervalModel, on plain spans
+void referenceDelete(QVector<Span> &spans, double start, double finish)
+{
+    int i = 0;
+
+    while (i < spans.size())
+    {
+        const double st = spans[i].start;
+        const double fn = spans[i].finish;
+
+        if (start > fn)
+        {
+            i++;
+            continue;
+        }
+
+        if (st > finish) break;
+
+        if (start > st && start <= fn && finish > fn)
+        {
+            spans[i].finish = start;
+            i++;
+            continue;
+        }
+
+        else if (finish > st && finish < fn && (start + 0.008 <= st || start - 0.008 < st))
+        {
+            spans[i].start = finish;
+            i++;
+            continue;
+        }
+
+        else if (start <= st && finish >= fn)
+        {
+            spans.remove(i);
+            continue;
+        }
+
+        else if (start > st && finish < fn)
+        {
+            spans[i] = {finish, fn};
+            spans.insert(i, {st, start});
+            i += 2;
+            continue;
+        }
+
+        // a cut ending exactly at the end of the interval: the old loop left it whole,
+        // IntervalModel trims it like any other cut at the end
+        if (start > st && finish == fn)
+            spans[i].finish = start;
+
+        i++;
+    }
+}
+
+// PlotWidget::addInterval before IntervalModel, on plain spans
+void referenceAdd(QVector<Span> &spans, double start, double finish)
+{
+    if (start > spans.back().finish)
+    {
+        spans.append({start, finish});
+        return;
+    }
+
+    double resStart = start;
+    int i = 0;
+
+    while (i < spans.size())
+    {
+        const double st = spans[i].start;
+        const double fn = spans[i].finish;
+
+        if (start > fn)
+        {
+            i++;
+            continue;
+        }
+
+        if (start >= st && finish <= fn) return;
+
+        if (start >= st && start <= fn) // first intersection
+        {
+            resStart = st;
+            spans.remove(i);
+            continue;
+        }
+
+        if (st > finish)
+        {
+            spans.insert(i, {resStart, finish});
+            return;
+        }
+
+        if (finish >= st && finish <= fn)
+        {
+            spans[i] = {resStart, fn};
+            return;
+        }
+
+        if (finish > fn)
+            spans.remove(i);
+    }
+
+    // the new interval swallowed every later one: the old loop dropped it here,
+    // IntervalModel inserts it
+    spans.append({resStart, finish});
+}
+
+// PlotWidget::cropIntervals before IntervalModel
+void referenceCrop(QVector<Span> &spans, double start, double finish)
+{
+    if (spans.isEmpty()) return;
+
+    const double st1 = spans.front().start;
+    const double fn2 = spans.back().finish;
+
+    if (st1 < start)
+        referenceDelete(spans, st1, start);
+
+    if (fn2 > finish)
+        referenceDelete(spans, finish, fn2);
+}
+
+QVector<double> bounds(const IntervalModel &model)
+{
+    QVector<double> out;
+
+    for (const IntervalModel::Interval &it : model)
+        out << it.start << it.finish;
+
+    return out;
+}
+
+QVector<double> bounds(const QVector<Span> &spans)
+{
+    QVector<double> out;
+
+    for (const Span &s : spans)
+        out << s.start << s.finish;
+
+    return out;
+}
+
+QVector<quint64> ids(const IntervalModel &model)
+{
+    QVector<quint64> out;
+
+    for (const IntervalModel::Interval &it : model)
+        out << it.id;
+
+    return out;
+}
+
+IntervalModel modelOf(const QVector<Span> &spans)
+{
+    IntervalModel model;
+
+    for (const Span &s : spans)
+        model.append(s.start, s.finish);
+
+    return model;
+}
+
+// samples of X inside [start, finish], by a plain search
+QVector<qsizetype> rangeOf(const TimeBase &X, double start, double finish)
+{
+    qsizetype first = 0;
+
+    while (first < X.size() && X[first] < start)
+        first++;
+
+    qsizetype end = first;
+
+    while (end < X.size() && X[end] <= finish)
+        end++;
+
+    return {first, end};
+}
+
+QVector<qsizetype> flat(const QVector<IntervalModel::SampleRange> &ranges)
+{
+    QVector<qsizetype> out;
+
+    for (const IntervalModel::SampleRange &r : ranges)
+        out << r.first << r.end;
+
+    return out;
+}
+
+QVector<qsizetype> expectedRanges(const IntervalModel &model, const TimeBase &X)
+{
+    QVector<qsizetype> out;
+
+    for (const IntervalModel::Interval &it : model)
+        out << rangeOf(X, it.start, it.finish);
+
+    return out;
+}
+
+// an edit boundary: anywhere, on an interval end, or just around one (within and past the 8 ms tolerance)
+double pickPoint(QRandomGenerator &random, const QVector<Span> &spans)
+{
+    const int kind = random.bounded(4);
+
+    if (kind == 0 || spans.isEmpty())
+        return random.generateDouble() * 110.0 - 5.0;
+
+    const Span &s = spans[random.bounded(int(spans.size()))];
+    const double end = random.bounded(2) ? s.start : s.finish;
+
+    if (kind == 1)
+        return end;
+
+    const double offsets[] {-0.01, -0.008, -0.004, 0.004, 0.008, 0.01};
+
+    return end + offsets[random.bounded(6)];
+}
+
+} // namespace
+
+void TestIntervalModel::trim()
+{
+    IntervalModel model = modelOf({{1.0, 2.0}, {3.0, 4.0}, {5.0, 6.0}});
+    const QVector<quint64> before = ids(model);
+
+    // the end of one interval and the beginning of the next
+    QVERIFY(model.subtract(1.5, 3.5));
+    QCOMPARE(bounds(model), (QVector<double> {1.0, 1.5, 3.5, 4.0, 5.0, 6.0}));
+    QCOMPARE(ids(model), before);
+
+    // a cut starting within 8 ms after the start trims the beginning instead of leaving a sliver
+    QVERIFY(model.subtract(5.005, 5.5));
+    QCOMPARE(bounds(model), (QVector<double> {1.0, 1.5, 3.5, 4.0, 5.5, 6.0}));
+
+    // a cut ending exactly at the end of an interval trims it (the old loop left it whole)
+    QVERIFY(model.subtract(3.8, 4.0));
+    QCOMPARE(bounds(model), (QVector<double> {1.0, 1.5, 3.5, 3.8, 5.5, 6.0}));
+
+    // a covered interval is dropped, a cut in a gap changes nothing
+    QVERIFY(model.subtract(3.0, 4.5));
+    QCOMPARE(bounds(model), (QVector<double> {1.0, 1.5, 5.5, 6.0}));
+
+    QVERIFY(!model.subtract(2.0, 5.0));
+    QCOMPARE(model.size(), 2);
+
+    // 8 ms after the start as the old loop compared it (start - 0.008 < st), rounding included
+    IntervalModel edge = modelOf({{0.014, 1.0}});
+
+    QVERIFY(edge.subtract(0.014 + 0.008, 0.5));
+    QCOMPARE(bounds(edge), (QVector<double> {0.5, 1.0}));
+}
+
+void TestIntervalModel::split()
+{
+    IntervalModel model = modelOf({{1.0, 2.0}, {3.0, 6.0}, {7.0, 8.0}});
+    const QVector<quint64> before = ids(model);
+
+    QVERIFY(model.subtract(4.0, 5.0));
+    QCOMPARE(bounds(model), (QVector<double> {1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0}));
+
+    // the left part keeps the id, the right part gets a new one
+    const QVector<quint64> after = ids(model);
+
+    QCOMPARE(after[0], before[0]);
+    QCOMPARE(after[1], before[1]);
+    QCOMPARE(after[3], before[2]);
+    QVERIFY(!before.contains(after[2]));
+
+    // lookups see the split
+    QCOMPARE(model.indexAt(4.5), qsizetype(-1));
+    QCOMPARE(model.indexAt(5.5), qsizetype(2));
+    QCOMPARE(model.firstEndingFrom(4.5), qsizetype(2));
+    QCOMPARE(model.firstEndingFrom(9.0), model.size());
+}
+
+void TestIntervalModel::merge()
+{
+    IntervalModel model = modelOf({{1.0, 2.0}, {3.0, 4.0}, {5.0, 6.0}, {7.0, 8.0}});
+    const QVector<quint64> before = ids(model);
+
+    // covered: nothing to do
+    QVERIFY(!model.unite(3.2, 3.8));
+
+    // joins the intervals it touches and keeps the id of the first
+    QVERIFY(model.unite(1.5, 5.0));
+    QCOMPARE(bounds(model), (QVector<double> {1.0, 6.0, 7.0, 8.0}));
+    QCOMPARE(ids(model).front(), before[0]);
+
+    // into a gap and after the last one
+    QVERIFY(model.unite(6.2, 6.8));
+    QVERIFY(model.unite(9.0, 10.0));
+    QCOMPARE(bounds(model), (QVector<double> {1.0, 6.0, 6.2, 6.8, 7.0, 8.0, 9.0, 10.0}));
+
+    // swallowing every later interval inserts the union (the old loop dropped them all)
+    QVERIFY(model.unite(6.5, 12.0));
+    QCOMPARE(bounds(model), (QVector<double> {1.0, 6.0, 6.2, 12.0}));
+}
+
+void TestIntervalModel::crop()
+{
+    IntervalModel model = modelOf({{1.0, 2.0}, {3.0, 4.0}, {5.0, 6.0}, {7.0, 8.0}});
+
+    QVERIFY(!model.crop(0.0, 9.0));
+
+    QVERIFY(model.crop(1.5, 7.5));
+    QCOMPARE(bounds(model), (QVector<double> {1.5, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 7.5}));
+
+    QVERIFY(model.crop(3.5, 4.5));
+    QCOMPARE(bounds(model), (QVector<double> {3.5, 4.0}));
+
+    QVERIFY(model.crop(10.0, 11.0));
+    QVERIFY(model.isEmpty());
+}
+
+void TestIntervalModel::parity_data()
+{
+    QTest::addColumn<quint32>("seed");
+
+    for (quint32 seed = 1; seed <= 200; seed++)
+        QTest::addRow("seed %u", seed) << seed;
+}
+
+void TestIntervalModel::parity()
+{
+    QFETCH(quint32, seed);
+
+    QRandomGenerator random(seed);
+
+    // disjoint intervals in [0, 100]
+    QVector<Span> spans;
+    double t = random.generateDouble();
+
+    while (t < 95.0)
+    {
+        const double length = 0.02 + random.generateDouble() * 4.0;
+
+        spans.append({t, t + length});
+        t += length + 0.001 + random.generateDouble() * 3.0;
+    }
+
+    IntervalModel model = modelOf(spans);
+
+    for (int op = 0; op < 40 && !spans.isEmpty(); op++)
+    {
+        double start = pickPoint(random, spans);
+        double finish = pickPoint(random, spans);
+
+        if (start > finish) std::swap(start, finish);
+
+        if (start == finish) continue; // a click, not a selection
+
+        switch (random.bounded(5))
+        {
+        case 0:
+        case 1:
+            referenceAdd(spans, start, finish);
+            model.unite(start, finish);
+            break;
+
+        case 2:
+        case 3:
+            referenceDelete(spans, start, finish);
+            model.subtract(start, finish);
+            break;
+
+        default:
+            referenceCrop(spans, start, finish);
+            model.crop(start, finish);
+        }
+
+        QCOMPARE(bounds(model), bounds(spans));
+    }
+}
+
+void TestIntervalModel::sampleRanges()
+{
+    QRandomGenerator random(20240920);
+
+    // an explicit curve with repeated timestamps and a uniform one
+    QVector<double> values;
+    double t = 0.0;
+
+    for (int i = 0; i < 20000; i++)
+    {
+        values.append(t);
+
+        if (random.bounded(50) != 0)
+            t += 0.004 + random.generateDouble() * 0.008;
+    }
+
+    const TimeBase curves[] {TimeBase(&values), TimeBase::uniformGrid(0.002, 0.008, 15000)};
+
+    // before the curves, across their start, along them and past their end
+    IntervalModel model = modelOf({{-1.0, -0.5}, {-0.2, 0.3}});
+
+    for (double s = 0.5; s < 120.0; s += 0.4 + random.generateDouble() * 3.0)
+        model.append(s, s + 0.01 + random.generateDouble() * 0.38);
+
+    // ends on samples, repeated ones included; 2^k - 1 samples long, where the doubling
+    // search of the end lands right on it
+    qsizetype i = std::lower_bound(values.begin(), values.end(), 121.0) - values.begin();
+
+    for (int length : {0, 1, 2, 3, 7, 15, 31, 63, 100, 127})
+    {
+        model.append(values[i], values[i + length]);
+        i += 150;
+    }
+
+    model.append(500.0, 501.0);
+
+    for (quint64 stamp : {1, 2})
+    {
+        const TimeBase &X = curves[stamp - 1];
+
+        QCOMPARE(flat(model.sampleRanges(X)), expectedRanges(model, X));
+        QCOMPARE(flat(model.sampleRanges(X, stamp)), expectedRanges(model, X));
+        QCOMPARE(flat(model.sampleRanges(X, stamp)), expectedRanges(model, X)); // from the cache
+    }
+}
+
+void TestIntervalModel::cacheAfterEdit()
+{
+    // two curve states with the same stamp expose what comes from the cache:
+    // cached ranges still refer to `before`, recomputed ones to `after`
+    QVector<double> beforeValues, afterValues;
+
+    for (int i = 0; i < 2000; i++)
+    {
+        beforeValues.append(0.01 * i);
+        afterValues.append(0.01 * i + 0.005);
+    }
+
+    const TimeBase before(&beforeValues), after(&afterValues);
+    const quint64 stamp = 42;
+
+    IntervalModel model = modelOf({{1.0, 2.0}, {3.0, 6.0}, {7.0, 8.0}, {9.0, 10.0}});
+
+    const QVector<qsizetype> cached = flat(model.sampleRanges(before, stamp));
+    QCOMPARE(cached, expectedRanges(model, before));
+
+    const IntervalModel copy = model;
+
+    // the split replaces interval 1 by two: only those two are searched again,
+    // the ones after it keep their cached ranges at their new positions
+    QVERIFY(model.subtract(4.0, 5.0));
+
+    const QVector<qsizetype> ranges = flat(model.sampleRanges(after, stamp));
+
+    QCOMPARE(ranges.mid(0, 2), rangeOf(before, 1.0, 2.0));
+    QCOMPARE(ranges.mid(2, 2), rangeOf(after, 3.0, 4.0));
+    QCOMPARE(ranges.mid(4, 2), rangeOf(after, 5.0, 6.0));
+    QCOMPARE(ranges.mid(6, 2), rangeOf(before, 7.0, 8.0));
+    QCOMPARE(ranges.mid(8, 2), rangeOf(before, 9.0, 10.0));
+
+    // a copy taken before the edit keeps the cache of its own intervals
+    QCOMPARE(flat(copy.sampleRanges(after, stamp)), cached);
+
+    // a merge forgets the ranges of the intervals it joined
+    QVERIFY(model.unite(7.5, 9.5));
+
+    const QVector<qsizetype> merged = flat(model.sampleRanges(after, stamp));
+
+    QCOMPARE(merged.mid(0, 2), rangeOf(before, 1.0, 2.0));
+    QCOMPARE(merged.mid(6, 2), rangeOf(after, 7.0, 10.0));
+
+    // a new stamp is computed from scratch; the oldest of the cached curves is dropped
+    QCOMPARE(flat(model.sampleRanges(after, 1)), expectedRanges(model, after));
+
+    for (quint64 other = 2; other <= 4; other++)
+        model.sampleRanges(after, other);
+
+    QCOMPARE(flat(model.sampleRanges(after, stamp)), expectedRanges(model, after));
+}
+
+QTEST_GUILESS_MAIN(TestIntervalModel)
+
+#include "tst_intervalmodel.moc"
@@ -0,0 +1,170 @@
+#include <QtTest>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include "FileConverter.h"
+#include "przparser.h"
+
+/*
+ * Compares PrzParser (directly and through FileConverter::loadFiles) with the
+ * QTextStream parser it replaced, on inline edge cases, on the fixtures in
+ * tests/data and on the recorded files in $DEPTHCALC_RECORDINGS.
+ */
+class TestPrzParser : public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void parse_data();
+
+    void parse();
+};
+
+namespace
+{
+
+struct Parsed
+{
+    QVector<double> X;
+    QVector<double> Y;
+
+    double startPoint {0.0};
+    double finishPoint {0.0};
+};
+
+// the parser used before PrzParser (loadPRZ), without progress reporting;
+// it indexed data[2] unchecked, here rows with fewer than 3 fields are skipped as PrzParser does
+void referencePRZ(const QString &path, Parsed &p)
+{
+    QFile prz(path);
+
+    if (!prz.open(QIODevice::ReadOnly))
+        return;
+
+    QTextStream in(&prz);
+
+    QStringList data = in.readLine().split(" ");
+    p.startPoint = data.value(0).toDouble();
+    p.finishPoint = data.value(2).toDouble();
+
+    while (!in.atEnd())
+    {
+        data = in.readLine().split(" ", Qt::SkipEmptyParts);
+
+        if (data.size() < 3) continue;
+
+        double num2 = data[0].replace(',', '.').toDouble();
+        int relTime = data[2].toInt();
+        double curSec = relTime / 1000.0 + static_cast<int>(p.startPoint / 1000);
+
+        p.X.append(curSec);
+        p.Y.append(num2);
+    }
+}
+
+void addFiles(const QString &dir)
+{
+    const QStringList files = QDir(dir).entryList({"*.prz"}, QDir::Files, QDir::Name);
+
+    for (const QString &name : files)
+    {
+        QFile file(QDir(dir).filePath(name));
+
+        if (file.open(QIODevice::ReadOnly))
+            QTest::newRow(qPrintable(name)) << file.readAll();
+    }
+}
+
+} // namespace
+
+void TestPrzParser::parse_data()
+{
+    QTest::addColumn<QByteArray>("text");
+
+    const QByteArray header = "1741767300123 - 1741767316123\n";
+
+    QTest::newRow("dot decimals") << header + "0.25 1 0\n-1.5 2 8\n3.125 3 16\n";
+    QTest::newRow("comma decimals") << header + "0,25 1 0\n-1,5 2 8\n3,125 3 16\n";
+    QTest::newRow("bom") << "\xEF\xBB\xBF" + header + "0,25 1 0\n-1,5 2 8\n";
+    QTest::newRow("crlf") << QByteArray("1741767300123 - 1741767316123\r\n0,25 1 0\r\n-1,5 2 8\r\n");
+    QTest::newRow("no final newline") << header + "0,25 1 0\n-1,5 2 8";
+    QTest::newRow("short rows") << header + "0,25 1 0\n0,5 7\n\n   \n1,75\n-1,5 2 8\n";
+    QTest::newRow("extra fields") << header + "0,25 1 0 9 9\n-1,5 2 8 x\n";
+    QTest::newRow("repeated spaces") << header + "  0,25   1  0\n-1,5 2   8  \n";
+    QTest::newRow("signs and junk") << header + "+0,25 1 +8\n-1,5 2 -8\nabc 3 16\n1,5 4 x\n";
+    QTest::newRow("fractional header") << QByteArray("1741767300123.5 x 1741767316123.25\n0,25 1 0\n");
+    QTest::newRow("header only") << QByteArray("1741767300123 - 1741767316123\n");
+    QTest::newRow("short header") << QByteArray("1741767300123\n0,25 1 0\n");
+
+    addFiles(DEPTHCALC_TEST_DATA);
+
+    const QString recordings = qEnvironmentVariable("DEPTHCALC_RECORDINGS");
+
+    if (!recordings.isEmpty())
+        addFiles(recordings);
+}
+
+void TestPrzParser::parse()
+{
+    QFETCH(QByteArray, text);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QString path = dir.filePath("test.prz");
+
+    {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QCOMPARE(file.write(text), qint64(text.size()));
+    }
+
+    Parsed expected;
+    referencePRZ(path, expected);
+
+    // the parser on the whole buffer
+    const char *data = text.constData();
+    const char *end = data + text.size();
+
+    double start, finish;
+    const char *body = data + PrzParser::parseHeader(data, text.size(), start, finish);
+
+    QCOMPARE(start, expected.startPoint);
+    QCOMPARE(finish, expected.finishPoint);
+
+    QVector<double> X(PrzParser::countLines(body, end));
+    QVector<double> Y(X.size());
+
+    const qsizetype rows = PrzParser::parseRows(body, end, start, X.data(), Y.data());
+    X.resize(rows);
+    Y.resize(rows);
+
+    QCOMPARE(X, expected.X);
+    QCOMPARE(Y, expected.Y);
+
+    // the concurrent chunked loader
+    FileConverter converter;
+    converter.set_file_path(path);
+
+    QSharedPointer<LoadedFile> loaded;
+    connect(&converter, &FileConverter::finished, this, [&](QSharedPointer<LoadedFile> file) {loaded = file;});
+
+    converter.loadFiles();
+
+    QVERIFY(loaded);
+    QCOMPARE(loaded->X, expected.X);
+    QCOMPARE(loaded->Y, expected.Y);
+
+    double startRef, finishRef;
+    converter.getSyncPoints(start, finish, startRef, finishRef);
+
+    QCOMPARE(start, expected.startPoint);
+    QCOMPARE(finish, expected.finishPoint);
+}
+
+QTEST_GUILESS_MAIN(TestPrzParser)
+
+#include "tst_przparser.moc"
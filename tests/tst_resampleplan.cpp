@@ -0,0 +1,273 @@
+#include <QtTest>
+#include <QRandomGenerator>
+#include <cstdlib>
+#include <cstring>
+#include "resampleplan.h"
+#include "timebase.h"
+
+/*
+ * Checks ResamplePlan::alignedInPlace against aligned() + apply() bit for
+ * bit, and counts the heap it uses on 24 hours of a DV sensor to confirm
+ * that the extra memory stays at a few blocks in both walk directions.
+ */
+class TestResamplePlan : public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void parity_data();
+
+    void parity();
+
+    void extraMemory_data();
+
+    void extraMemory();
+};
+
+#ifdef __GLIBC__
+#include <malloc.h>
+
+// glibc lets the test replace malloc and friends, which also catches operator new
+// and the QVector allocations
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+extern "C" void __libc_free(void *ptr);
+
+#define RESAMPLE_TEST_COUNTS_HEAP
+#endif
+
+namespace
+{
+
+#ifdef RESAMPLE_TEST_COUNTS_HEAP
+
+// live heap while counting is on
+bool counting = false;
+qint64 live = 0;
+qint64 peak = 0;
+
+void allocated(void *ptr)
+{
+    if (!counting || !ptr) return;
+
+    live += qint64(malloc_usable_size(ptr));
+    peak = qMax(peak, live);
+}
+
+void released(void *ptr)
+{
+    if (counting && ptr)
+        live -= qint64(malloc_usable_size(ptr));
+}
+
+#endif
+
+// evenly sampled at about 125 Hz with jitter; kind adds gaps, equal or swapped timestamps
+QVector<double> timestamps(QRandomGenerator &random, qsizetype n, int kind)
+{
+    const double dt = 0.008;
+
+    QVector<double> X(n);
+    double t = random.bounded(2) ? 1.7e9 + random.generateDouble() * 1000.0 : random.generateDouble() * 100.0;
+
+    for (qsizetype i = 0; i < n; i++)
+    {
+        X[i] = t;
+        t += dt * (1.0 + 0.3 * (random.generateDouble() - 0.5));
+
+        if ((kind == 1 || kind == 4) && random.bounded(500) == 0)
+            t += 0.1 + random.generateDouble() * 5.0;                   // a gap
+
+        if ((kind == 2 || kind == 4) && i > 0 && random.bounded(100) == 0)
+            X[i] = X[i - 1];                                            // equal timestamps
+
+        if ((kind == 3 || kind == 4) && i > 0 && random.bounded(200) == 0)
+            std::swap(X[i], X[i - 1]);                                  // out of order
+    }
+
+    return X;
+}
+
+QVector<double> channel(QRandomGenerator &random, qsizetype n)
+{
+    QVector<double> Y(n);
+
+    for (qsizetype i = 0; i < n; i++)
+        Y[i] = random.generateDouble() * 2.0e6 - 1.0e6;
+
+    return Y;
+}
+
+bool sameBits(const QVector<double> &a, const QVector<double> &b)
+{
+    return a.size() == b.size()
+           && (a.isEmpty() || memcmp(a.constData(), b.constData(), a.size() * sizeof(double)) == 0);
+}
+
+} // namespace
+
+#ifdef RESAMPLE_TEST_COUNTS_HEAP
+
+extern "C" void *malloc(size_t size) noexcept
+{
+    void *ptr = __libc_malloc(size);
+    allocated(ptr);
+    return ptr;
+}
+
+extern "C" void *calloc(size_t count, size_t size) noexcept
+{
+    void *ptr = __libc_calloc(count, size);
+    allocated(ptr);
+    return ptr;
+}
+
+extern "C" void *realloc(void *ptr, size_t size) noexcept
+{
+    released(ptr);
+    void *result = __libc_realloc(ptr, size);
+    allocated(result ? result : ptr);   // a failed realloc keeps the old block
+    return result;
+}
+
+extern "C" void free(void *ptr) noexcept
+{
+    released(ptr);
+    __libc_free(ptr);
+}
+
+#endif
+
+void TestResamplePlan::parity_data()
+{
+    QTest::addColumn<QVector<double>>("X");
+    QTest::addColumn<double>("step");
+    QTest::addColumn<double>("factor");
+    QTest::addColumn<quint32>("seed");
+
+    // factor < 1 or a coarser step gives a sparser grid (walked front to back),
+    // factor > 1 or a finer step a denser one (walked back to front)
+    const double steps[] {0.008, 0.004, 0.016, 0.1, 0.0025};
+    const double factors[] {1.0, 0.999, 1.001, 0.5, 2.0, 0.97, 1.03};
+    const char *kinds[] {"jitter", "gaps", "equal", "out of order", "mixed"};
+
+    QRandomGenerator random(20240907);
+
+    for (int i = 0; i < 200; i++)
+    {
+        const int kind = i % 5;
+        const qsizetype n = i < 15 ? 1 + i % 3 : 1 + random.bounded(4000);
+        const double step = steps[(i / 5) % 5];
+        const double factor = factors[(i / 25) % 7];
+
+        QTest::addRow("%d %s n=%lld step=%g factor=%g", i, kinds[kind], qint64(n), step, factor)
+            << timestamps(random, n, kind) << step << factor << random.generate();
+    }
+}
+
+void TestResamplePlan::parity()
+{
+    QFETCH(QVector<double>, X);
+    QFETCH(double, step);
+    QFETCH(double, factor);
+    QFETCH(quint32, seed);
+
+    QRandomGenerator random(seed);
+
+    const QVector<double> axisX = channel(random, X.size());
+    const QVector<double> axisZ = channel(random, X.size());
+
+    const TimeBase timeBase(&X);
+
+    // the stored plan
+    const ResamplePlan plan = ResamplePlan::aligned(timeBase, step, factor);
+
+    QVector<double> expectedX, expectedZ;
+    QVERIFY(plan.apply(axisX, expectedX));
+    QVERIFY(plan.apply(axisZ, expectedZ));
+
+    // in place; inPlaceZ shares its data with axisZ, the walk must detach it first
+    QVector<double> inPlaceX = axisX;
+    inPlaceX.detach();
+
+    QVector<double> inPlaceZ = axisZ;
+
+    QVector<double> originalZ = axisZ;
+    originalZ.detach();
+
+    TimeBase grid;
+    QVERIFY(ResamplePlan::alignedInPlace(timeBase, step, factor, {&inPlaceX, &inPlaceZ}, grid));
+
+    QVERIFY(sameBits(inPlaceX, expectedX));
+    QVERIFY(sameBits(inPlaceZ, expectedZ));
+    QVERIFY(sameBits(axisZ, originalZ));
+
+    QVERIFY(grid.isUniform());
+    QCOMPARE(grid.size(), plan.size());
+
+    if (!plan.isEmpty())
+    {
+        QCOMPARE(grid.gridStart(), plan.start());
+        QCOMPARE(grid.gridStep(), plan.step());
+    }
+}
+
+void TestResamplePlan::extraMemory_data()
+{
+    QTest::addColumn<double>("factor");
+
+    QTest::newRow("sparser grid, front to back") << 0.999;
+    QTest::newRow("denser grid, back to front") << 1.001;
+}
+
+void TestResamplePlan::extraMemory()
+{
+#ifndef RESAMPLE_TEST_COUNTS_HEAP
+    QSKIP("the heap is counted through the glibc allocator only");
+#else
+    QFETCH(double, factor);
+
+    // 24 hours at 125 Hz: the X and Z axes of a DV sensor
+    const qsizetype n = 24 * 3600 * 125;
+    const double step = 0.008;
+
+    QRandomGenerator random(7);
+
+    QVector<double> X = timestamps(random, n, 0);
+    QVector<double> axisX = channel(random, n);
+    QVector<double> axisZ = channel(random, n);
+
+    const TimeBase timeBase(&X);
+    TimeBase grid;
+
+    live = 0;
+    peak = 0;
+    counting = true;
+
+    const bool done = ResamplePlan::alignedInPlace(timeBase, step, factor, {&axisX, &axisZ}, grid);
+
+    counting = false;
+
+    QVERIFY(done);
+
+    // what is still allocated at the end is the growth of the channels to a denser grid
+    // (Qt grows an array geometrically); anything above it at the peak was extra memory
+    const qsizetype m = grid.size();
+    const qint64 extra = peak - live;
+
+    qDebug() << "samples" << n << "->" << m << "extra heap" << extra << "bytes";
+
+    QCOMPARE(axisX.size(), m);
+    QCOMPARE(axisZ.size(), m);
+
+    // a stored plan alone would take 16 bytes per output sample (about 170 MB here),
+    // a copy of a channel 86 MB
+    QVERIFY2(extra < 256 * 1024, qPrintable(QString("extra heap: %1 bytes").arg(extra)));
+#endif
+}
+
+QTEST_GUILESS_MAIN(TestResamplePlan)
+
+#include "tst_resampleplan.moc"
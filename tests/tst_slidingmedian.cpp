@@ -0,0 +1,235 @@
+#include <QtTest>
+#include <QRandomGenerator>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "slidingmedian.h"
+
+/*
+ * Compares SlidingMedian, driven the way each of its call sites drives it,
+ * bit for bit with the three medians it replaced: the DN filter
+ * (FileConverter), the calibration filter (CalibrationManager) and the DV
+ * filter of the PRZ angle (PrzManager).
+ */
+class TestSlidingMedian : public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void callSites_data();
+
+    void callSites();
+};
+
+namespace
+{
+
+// FileConverter::medianFilter before SlidingMedian: window clamped to the first/last sample
+void referenceDn(QVector<double> &data, int radius)
+{
+    if (data.isEmpty() || radius < 1) return;
+
+    QVector<double> result(data.size());
+
+    for (int i = 0; i < data.size(); ++i)
+    {
+        QVector<double> window;
+        for (int j = -radius; j <= radius; ++j)
+        {
+            int idx = i + j;
+            if (idx < 0) idx = 0;
+            if (idx >= data.size()) idx = data.size() - 1;
+            window.append(data[idx]);
+        }
+
+        std::sort(window.begin(), window.end());
+        result[i] = window[radius];
+    }
+
+    data.swap(result);
+}
+
+// CalibrationManager::medianFilter before SlidingMedian
+QVector<double> referenceCalibration(const QVector<double> &data, int windowSize)
+{
+    if (data.isEmpty() || windowSize < 1)
+        return data;
+
+    if (windowSize % 2 == 0)
+        windowSize++;
+
+    int radius = windowSize / 2;
+    QVector<double> result(data.size());
+
+    for (int i = 0; i < data.size(); ++i)
+    {
+        QVector<double> window;
+        for (int j = -radius; j <= radius; ++j)
+        {
+            int idx = i + j;
+            if (idx < 0) idx = 0;
+            if (idx >= data.size()) idx = data.size() - 1;
+            window.append(data[idx]);
+        }
+
+        std::sort(window.begin(), window.end());
+        result[i] = window[radius];
+    }
+
+    return result;
+}
+
+// PrzManager::medianFilter before SlidingMedian: window shrunk at the edges
+void referencePrz(QVector<double> &data, int n)
+{
+    const int N = data.size();
+    if (N == 0 || n <= 0) return;
+
+    QVector<double> out(N);
+    std::vector<double> buf;
+    buf.reserve(2 * n + 1);
+
+    for (int i = 0; i < N; ++i)
+    {
+        const int L = std::max(0, i - n);
+        const int R = std::min(N - 1, i + n);
+        const int M = R - L + 1;
+
+        buf.assign(data.begin() + L, data.begin() + R + 1);
+
+        auto mid = buf.begin() + (M / 2);
+        std::nth_element(buf.begin(), mid, buf.end());
+
+        if (M % 2 == 1)
+        {
+            out[i] = *mid;
+        }
+
+        else
+        {
+            const double m1 = *mid;
+            const double m0 = *std::max_element(buf.begin(), mid);
+            out[i] = 0.5 * (m0 + m1);
+        }
+    }
+
+    data.swap(out);
+}
+
+// push() in blocks and flush(), as FileConverter::medianFilter and PrzKernels::dvlAngle
+// do; the engine is used twice to check that flush() leaves it ready for new data
+QVector<double> streamed(const QVector<double> &data, int radius, SlidingMedian::Edge edge)
+{
+    if (data.isEmpty() || radius < 1) return data;
+
+    constexpr qsizetype block = 1024;
+
+    SlidingMedian median(radius, edge);
+    QVector<double> out;
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        out = QVector<double>(data.size());
+        qsizetype k = 0;
+
+        for (qsizetype first = 0; first < data.size(); first += block)
+        {
+            const qsizetype last = qMin(first + block, data.size());
+
+            for (qsizetype i = first; i < last; ++i)
+            {
+                if (median.push(data[i], out[k]))
+                    k++;
+            }
+        }
+
+        k += median.flush(out.data() + k);
+
+        if (k != data.size()) return {};
+    }
+
+    return out;
+}
+
+bool sameBits(const QVector<double> &a, const QVector<double> &b)
+{
+    return a.size() == b.size()
+           && (a.isEmpty() || memcmp(a.constData(), b.constData(), a.size() * sizeof(double)) == 0);
+}
+
+} // namespace
+
+void TestSlidingMedian::callSites_data()
+{
+    QTest::addColumn<QVector<double>>("data");
+    QTest::addColumn<int>("radius");
+
+    QRandomGenerator random(20240611);
+
+    const QList<int> sizes {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 14, 15, 16, 17, 63, 100, 1023, 1024, 1025, 4099};
+    const QList<int> radii {0, 1, 2, 3, 4, 5, 7, 8, 16, 63, 300};
+
+    for (int n : sizes)
+    {
+        // noise, many repeated values (24-bit counts), a ramp and a constant;
+        // DN/DV counts and their differences never hold -0.0 or NaN, so neither do these
+        QVector<double> noise(n), repeated(n), ramp(n), constant(n, 42.0);
+
+        for (int i = 0; i < n; i++)
+        {
+            noise[i] = random.generateDouble() * 2.0e6 - 1.0e6;
+            repeated[i] = double(random.bounded(-4, 5)) * 3.25;
+            ramp[i] = 0.5 * i;
+        }
+
+        for (int radius : radii)
+        {
+            QTest::addRow("noise n=%d r=%d", n, radius) << noise << radius;
+            QTest::addRow("repeated n=%d r=%d", n, radius) << repeated << radius;
+            QTest::addRow("ramp n=%d r=%d", n, radius) << ramp << radius;
+            QTest::addRow("constant n=%d r=%d", n, radius) << constant << radius;
+        }
+    }
+}
+
+void TestSlidingMedian::callSites()
+{
+    QFETCH(QVector<double>, data);
+    QFETCH(int, radius);
+
+    // DN filter: streamed with clamped edges
+    QVector<double> dn = data;
+    referenceDn(dn, radius);
+
+    QVERIFY(sameBits(streamed(data, radius, SlidingMedian::Edge::Clamp), dn));
+
+    QVector<double> clamped = data;
+    SlidingMedian::filter(clamped, radius, SlidingMedian::Edge::Clamp);
+    QVERIFY(sameBits(clamped, dn));
+
+    // calibration filter: whole array, window 2 * radius + 1 (and the even window below it)
+    for (int windowSize : {2 * radius + 1, 2 * radius})
+    {
+        QVector<double> calibrated = data;
+
+        if (windowSize >= 1)
+            SlidingMedian::filter(calibrated, (windowSize | 1) / 2, SlidingMedian::Edge::Clamp);
+
+        QVERIFY(sameBits(calibrated, referenceCalibration(data, windowSize)));
+    }
+
+    // DV filter of the PRZ angle: streamed with shrinking edges
+    QVector<double> dv = data;
+    referencePrz(dv, radius);
+
+    QVERIFY(sameBits(streamed(data, radius, SlidingMedian::Edge::Shrink), dv));
+
+    QVector<double> shrunk = data;
+    SlidingMedian::filter(shrunk, radius, SlidingMedian::Edge::Shrink);
+    QVERIFY(sameBits(shrunk, dv));
+}
+
+QTEST_GUILESS_MAIN(TestSlidingMedian)
+
+#include "tst_slidingmedian.moc"